@@ -17,6 +17,12 @@
 
 TEST_PATH=tests/$(TEST)
 
+ifeq ($(strip $(SPARSE_KEYMAP_ENABLE)), yes)
+    SPARSE_KEYMAP_OBJ := $(TEST_OBJ)/$(TEST)/$(TEST_PATH)/keymap.o
+    SPARSE_KEYMAP_TABLE := $(TEST_OBJ)/$(TEST)/keymap_sparse_table.c
+    SRC += $(SPARSE_KEYMAP_TABLE)
+endif
+
 $(TEST)_SRC= \
 	$(TEST_PATH)/keymap.c \
 	$(TMK_COMMON_SRC) \
@@ -25,9 +31,10 @@ $(TEST)_SRC= \
 	tests/test_common/matrix.c \
 	tests/test_common/test_driver.cpp \
 	tests/test_common/keyboard_report_util.cpp \
-	tests/test_common/test_fixture.cpp
+	tests/test_common/test_fixture.cpp \
+	tests/test_common/flight_replay.cpp
 $(TEST)_SRC += $(patsubst $(ROOTDIR)/%,%,$(wildcard $(TEST_PATH)/*.cpp))
 
 $(TEST)_DEFS=$(TMK_COMMON_DEFS) $(OPT_DEFS)
-$(TEST)_CONFIG=$(TEST_PATH)/config.h
+$(TEST)_CONFIG=$(wildcard $(TEST_PATH)/config.h) tests/test_common/test_config.h
 VPATH+=$(TOP_DIR)/tests/test_common
\ No newline at end of file
@@ -23,6 +23,13 @@ KEYBOARD_FILESAFE := $(subst /,_,$(KEYBOARD))
 TARGET ?= $(KEYBOARD_FILESAFE)_$(KEYMAP)
 KEYBOARD_OUTPUT := $(BUILD_DIR)/obj_$(KEYBOARD_FILESAFE)
 
+# The sim target builds the keymap for the host, see tmk_core/protocol/sim
+ifneq ($(filter sim,$(MAKECMDGOALS)),)
+    SIM := yes
+    TARGET := $(TARGET)_sim
+    KEYBOARD_OUTPUT := $(KEYBOARD_OUTPUT)_sim
+endif
+
 # Force expansion
 TARGET := $(TARGET)
 
@@ -92,6 +99,12 @@ ifneq ("$(wildcard $(KEYBOARD_C_1))","")
     KEYBOARD_SRC += $(KEYBOARD_C_1)
 endif
 
+# The simulator keeps the <keyboard>.c files, whose registers and I2C bus are
+# stubbed out, but leaves out the matrix and drivers that the keyboard adds
+ifeq ($(SIM),yes)
+    SRC =
+endif
+
 OPT_DEFS += -DKEYBOARD_$(KEYBOARD_FILESAFE)
 
 
@@ -111,8 +124,10 @@ ifneq ("$(wildcard $(KEYBOARD_PATH_5)/$(KEYBOARD_FOLDER_5).h)","")
     QMK_KEYBOARD_H = $(KEYBOARD_FOLDER_5).h
 endif
 
+ifeq ($(SIM),yes)
+    PLATFORM=SIM
 # We can assume a ChibiOS target When MCU_FAMILY is defined , since it's not used for LUFA
-ifdef MCU_FAMILY
+else ifdef MCU_FAMILY
     FIRMWARE_FORMAT=bin
     PLATFORM=CHIBIOS
 else
@@ -120,6 +135,10 @@ else
     FIRMWARE_FORMAT=hex
 endif
 
+ifeq ($(PLATFORM),SIM)
+    include $(TMK_PATH)/native.mk
+endif
+
 ifeq ($(PLATFORM),CHIBIOS)
     include $(TMK_PATH)/chibios.mk
     OPT_OS = chibios
@@ -238,11 +257,22 @@ VPATH += $(KEYBOARD_PATHS)
 VPATH += $(COMMON_VPATH)
 VPATH += $(USER_PATH)
 
+ifeq ($(PLATFORM),SIM)
+    include $(TMK_PATH)/protocol/sim.mk
+endif
+
 include common_features.mk
 include $(TMK_PATH)/protocol.mk
 include $(TMK_PATH)/common.mk
 include bootloader.mk
 
+# The tables of the sparse keymap are generated from the compiled keymap
+ifeq ($(strip $(SPARSE_KEYMAP_ENABLE)), yes)
+    SPARSE_KEYMAP_OBJ := $(KEYMAP_OUTPUT)/$(KEYMAP_C:.c=.o)
+    SPARSE_KEYMAP_TABLE := $(KEYMAP_OUTPUT)/keymap_sparse_table.c
+    SRC += $(SPARSE_KEYMAP_TABLE)
+endif
+
 SRC += $(TMK_COMMON_SRC)
 OPT_DEFS += $(TMK_COMMON_DEFS)
 EXTRALDFLAGS += $(TMK_COMMON_LDFLAGS)
@@ -291,3 +321,16 @@ build: elf cpfirmware
 
 
 include $(TMK_PATH)/rules.mk
+
+ifeq ($(PLATFORM),SIM)
+# The keymap with its features as a host library, and the driver linked with it
+SIM_LIB := $(BUILD_DIR)/lib$(TARGET).a
+
+sim: $(BUILD_DIR)/$(TARGET).elf $(SIM_LIB)
+	$(SILENT) || printf "Built $(BUILD_DIR)/$(TARGET).elf, run it with --help for the workloads\n"
+
+$(SIM_LIB): $(filter-out %/sim_main.o,$(OBJ))
+	@$(SILENT) || printf "Archiving $@" | $(AWK_CMD)
+	$(eval CMD=$(REMOVE) $@ && ar rcs $@ $^)
+	@$(BUILD_CMD)
+endif
@@ -43,12 +43,18 @@ VPATH += $(COMMON_VPATH)
 PLATFORM:=TEST
 
 ifneq ($(filter $(FULL_TESTS),$(TEST)),)
+# the tests in tests/ all use the matrix of tests/test_common
+CUSTOM_MATRIX = yes
 include tests/$(TEST)/rules.mk
 endif
 
 include common_features.mk
 include $(TMK_PATH)/common.mk
 include $(QUANTUM_PATH)/serial_link/tests/rules.mk
+include $(QUANTUM_PATH)/debounce/tests/rules.mk
+include $(QUANTUM_PATH)/split_common/tests/rules.mk
+include $(QUANTUM_PATH)/tests/rules.mk
+include $(TMK_PATH)/common/tests/rules.mk
 ifneq ($(filter $(FULL_TESTS),$(TEST)),)
 include build_full_test.mk
 endif
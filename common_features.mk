@@ -57,6 +57,8 @@ endif
 ifeq ($(strip $(COMBO_ENABLE)), yes)
     OPT_DEFS += -DCOMBO_ENABLE
     SRC += $(QUANTUM_DIR)/process_keycode/process_combo.c
+    # the combo timeout is a deferred callback
+    DEFERRED_ENABLE = yes
 endif
 
 ifeq ($(strip $(STENO_ENABLE)), yes)
@@ -126,6 +128,8 @@ endif
 ifeq ($(strip $(TAP_DANCE_ENABLE)), yes)
     OPT_DEFS += -DTAP_DANCE_ENABLE
     SRC += $(QUANTUM_DIR)/process_keycode/process_tap_dance.c
+    # the tap dance timeout is a deferred callback
+    DEFERRED_ENABLE = yes
 endif
 
 ifeq ($(strip $(KEY_LOCK_ENABLE)), yes)
@@ -203,6 +207,11 @@ ifeq ($(strip $(HD44780_ENABLE)), yes)
 	OPT_DEFS += -DHD44780_ENABLE
 endif
 
+ifeq ($(strip $(SPARSE_KEYMAP_ENABLE)), yes)
+    SRC += $(QUANTUM_DIR)/keymap_sparse.c
+    OPT_DEFS += -DSPARSE_KEYMAP_ENABLE
+endif
+
 QUANTUM_SRC:= \
     $(QUANTUM_DIR)/quantum.c \
     $(QUANTUM_DIR)/keymap_common.c \
@@ -217,10 +226,21 @@ ifndef CUSTOM_MATRIX
     endif
 endif
 
+DEBOUNCE_DIR:= $(QUANTUM_DIR)/debounce
+DEBOUNCE_TYPE?= sym_g
+VALID_DEBOUNCE_TYPES := sym_g sym_pr sym_pk eager_pk custom
+ifeq ($(filter $(DEBOUNCE_TYPE),$(VALID_DEBOUNCE_TYPES)),)
+    $(error DEBOUNCE_TYPE="$(DEBOUNCE_TYPE)" is not a valid debounce algorithm)
+endif
+ifneq ($(strip $(DEBOUNCE_TYPE)), custom)
+    QUANTUM_SRC += $(DEBOUNCE_DIR)/$(strip $(DEBOUNCE_TYPE)).c
+endif
+
 ifeq ($(strip $(SPLIT_KEYBOARD)), yes)
     OPT_DEFS += -DSPLIT_KEYBOARD
     QUANTUM_SRC += $(QUANTUM_DIR)/split_common/split_flags.c \
                 $(QUANTUM_DIR)/split_common/split_util.c \
                 $(QUANTUM_DIR)/split_common/i2c.c \
-                $(QUANTUM_DIR)/split_common/serial.c  
+                $(QUANTUM_DIR)/split_common/serial.c \
+                $(QUANTUM_DIR)/split_common/split_protocol.c
 endif
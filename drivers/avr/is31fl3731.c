@@ -66,7 +66,21 @@ uint8_t g_twi_transfer_buffer[20];
 // buffers and the transfers in IS31FL3731_write_pwm_buffer() but it's
 // probably not worth the extra complexity.
 uint8_t g_pwm_buffer[DRIVER_COUNT][144];
-bool g_pwm_buffer_update_required = false;
+
+// One bit per 16 register block of g_pwm_buffer, i.e. per I2C transfer,
+// set when a register in the block changes. Only those blocks are sent.
+uint16_t g_pwm_buffer_dirty[DRIVER_COUNT] = { 0 };
+
+#ifdef ISSI_DOUBLE_BUFFER
+// With double buffering the PWM registers are written to the frame that isn't
+// displayed, and the frames are swapped afterwards. That frame was last written
+// two updates ago, so it also needs the blocks that changed in the previous one.
+static uint16_t g_pwm_buffer_dirty_prev[DRIVER_COUNT] = { 0 };
+static uint8_t g_displayed_frame[DRIVER_COUNT] = { 0 };
+#define ISSI_FRAME_COUNT 2
+#else
+#define ISSI_FRAME_COUNT 1
+#endif
 
 uint8_t g_led_control_registers[DRIVER_COUNT][18] = { { 0 }, { 0 } };
 bool g_led_control_registers_update_required = false;
@@ -102,14 +116,23 @@ void IS31FL3731_write_register( uint8_t addr, uint8_t reg, uint8_t data )
 }
 
 void IS31FL3731_write_pwm_buffer( uint8_t addr, uint8_t *pwm_buffer )
+{
+	IS31FL3731_write_pwm_blocks( addr, pwm_buffer, 0x1FF );
+}
+
+void IS31FL3731_write_pwm_blocks( uint8_t addr, uint8_t *pwm_buffer, uint16_t blocks )
 {
 	// assumes bank is already selected
 
-	// transmit PWM registers in 9 transfers of 16 bytes
+	// transmit PWM registers in up to 9 transfers of 16 bytes
 	// g_twi_transfer_buffer[] is 20 bytes
 
 	// iterate over the pwm_buffer contents at 16 byte intervals
 	for ( int i = 0; i < 144; i += 16 ) {
+		// skip the blocks that haven't changed
+		if ( !( blocks & ( 1 << ( i / 16 ) ) ) ) {
+			continue;
+		}
 		// set the first register, e.g. 0x24, 0x34, 0x44, etc.
 		g_twi_transfer_buffer[0] = 0x24 + i;
 		// copy the data from i to i+15
@@ -152,25 +175,28 @@ void IS31FL3731_init( uint8_t addr )
 	// audio sync off
 	IS31FL3731_write_register( addr, ISSI_REG_AUDIOSYNC, 0x00 );
 
-	// select bank 0
-	IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, 0 );
-
-	// turn off all LEDs in the LED control register
-	for ( int i = 0x00; i <= 0x11; i++ )
+	for ( uint8_t frame = 0; frame < ISSI_FRAME_COUNT; frame++ )
 	{
-		IS31FL3731_write_register( addr, i, 0x00 );
-	}
+		// select the frame's bank
+		IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, frame );
 
-	// turn off all LEDs in the blink control register (not really needed)
-	for ( int i = 0x12; i <= 0x23; i++ )
-	{
-		IS31FL3731_write_register( addr, i, 0x00 );
-	}
+		// turn off all LEDs in the LED control register
+		for ( int i = 0x00; i <= 0x11; i++ )
+		{
+			IS31FL3731_write_register( addr, i, 0x00 );
+		}
 
-	// set PWM on all LEDs to 0
-	for ( int i = 0x24; i <= 0xB3; i++ )
-	{
-		IS31FL3731_write_register( addr, i, 0x00 );
+		// turn off all LEDs in the blink control register (not really needed)
+		for ( int i = 0x12; i <= 0x23; i++ )
+		{
+			IS31FL3731_write_register( addr, i, 0x00 );
+		}
+
+		// set PWM on all LEDs to 0
+		for ( int i = 0x24; i <= 0xB3; i++ )
+		{
+			IS31FL3731_write_register( addr, i, 0x00 );
+		}
 	}
 
 	// select "function register" bank
@@ -180,22 +206,31 @@ void IS31FL3731_init( uint8_t addr )
 	IS31FL3731_write_register( addr, ISSI_REG_SHUTDOWN, 0x01 );
 
 	// select bank 0 and leave it selected.
-	// most usage after initialization is just writing PWM buffers in bank 0
-	// as there's not much point in double-buffering
+	// most usage after initialization is just writing PWM buffers in bank 0,
+	// unless ISSI_DOUBLE_BUFFER is defined, then the banks are selected as needed
 	IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, 0 );
 
 }
 
+static inline void IS31FL3731_set_pwm( uint8_t driver, uint8_t reg, uint8_t value )
+{
+	// Subtract 0x24 to get the second index of g_pwm_buffer
+	uint8_t i = reg - 0x24;
+
+	if ( g_pwm_buffer[driver][i] != value ) {
+		g_pwm_buffer[driver][i] = value;
+		g_pwm_buffer_dirty[driver] |= 1 << ( i / 16 );
+	}
+}
+
 void IS31FL3731_set_color( int index, uint8_t red, uint8_t green, uint8_t blue )
 {
 	if ( index >= 0 && index < DRIVER_LED_TOTAL ) {
 		is31_led led = g_is31_leds[index];
 
-		// Subtract 0x24 to get the second index of g_pwm_buffer
-		g_pwm_buffer[led.driver][led.r - 0x24] = red;
-		g_pwm_buffer[led.driver][led.g - 0x24] = green;
-		g_pwm_buffer[led.driver][led.b - 0x24] = blue;
-		g_pwm_buffer_update_required = true;
+		IS31FL3731_set_pwm( led.driver, led.r, red );
+		IS31FL3731_set_pwm( led.driver, led.g, green );
+		IS31FL3731_set_pwm( led.driver, led.b, blue );
 	}
 }
 
@@ -238,25 +273,59 @@ void IS31FL3731_set_led_control_register( uint8_t index, bool red, bool green, b
 
 }
 
-void IS31FL3731_update_pwm_buffers( uint8_t addr1, uint8_t addr2 )
+#ifdef ISSI_DOUBLE_BUFFER
+static void IS31FL3731_update_pwm_frame( uint8_t addr, uint8_t driver, uint8_t frame )
 {
-	if ( g_pwm_buffer_update_required )
+	IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, frame );
+	IS31FL3731_write_pwm_blocks( addr, g_pwm_buffer[driver],
+		g_pwm_buffer_dirty[driver] | g_pwm_buffer_dirty_prev[driver] );
+	g_pwm_buffer_dirty_prev[driver] = g_pwm_buffer_dirty[driver];
+	g_pwm_buffer_dirty[driver] = 0;
+
+	// show the frame that was just written
+	IS31FL3731_write_register( addr, ISSI_COMMANDREGISTER, ISSI_BANK_FUNCTIONREG );
+	IS31FL3731_write_register( addr, ISSI_REG_PICTUREFRAME, frame );
+}
+#endif
+
+void IS31FL3731_update_pwm_buffer( uint8_t addr, uint8_t index )
+{
+	if ( g_pwm_buffer_dirty[index] )
 	{
-		IS31FL3731_write_pwm_buffer( addr1, g_pwm_buffer[0] );
-		IS31FL3731_write_pwm_buffer( addr2, g_pwm_buffer[1] );
+#ifdef ISSI_DOUBLE_BUFFER
+		uint8_t frame = g_displayed_frame[index] ^ 1;
+		IS31FL3731_update_pwm_frame( addr, index, frame );
+		g_displayed_frame[index] = frame;
+#else
+		IS31FL3731_write_pwm_blocks( addr, g_pwm_buffer[index], g_pwm_buffer_dirty[index] );
+		g_pwm_buffer_dirty[index] = 0;
+#endif
 	}
-	g_pwm_buffer_update_required = false;
+}
+
+void IS31FL3731_update_pwm_buffers( uint8_t addr1, uint8_t addr2 )
+{
+	IS31FL3731_update_pwm_buffer( addr1, 0 );
+	IS31FL3731_update_pwm_buffer( addr2, 1 );
 }
 
 void IS31FL3731_update_led_control_registers( uint8_t addr1, uint8_t addr2 )
 {
 	if ( g_led_control_registers_update_required )
 	{
-		for ( int i=0; i<18; i++ )
+		// the LED control registers are part of each frame
+		for ( uint8_t frame = 0; frame < ISSI_FRAME_COUNT; frame++ )
 		{
-			IS31FL3731_write_register(addr1, i, g_led_control_registers[0][i] );
-			IS31FL3731_write_register(addr2, i, g_led_control_registers[1][i] );
+#ifdef ISSI_DOUBLE_BUFFER
+			IS31FL3731_write_register( addr1, ISSI_COMMANDREGISTER, frame );
+			IS31FL3731_write_register( addr2, ISSI_COMMANDREGISTER, frame );
+#endif
+			for ( int i=0; i<18; i++ )
+			{
+				IS31FL3731_write_register(addr1, i, g_led_control_registers[0][i] );
+				IS31FL3731_write_register(addr2, i, g_led_control_registers[1][i] );
+			}
 		}
 	}
+	g_led_control_registers_update_required = false;
 }
-
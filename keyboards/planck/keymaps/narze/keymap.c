@@ -275,6 +275,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         persistant_default_layer_set(1UL<<_QWERTY);
 
         key_combos[CB_SUPERDUPER].keys = superduper_combos[_QWERTY];
+        combo_keys_changed();
         eeprom_update_byte(EECONFIG_SUPERDUPER_INDEX, _QWERTY);
       }
       return false;
@@ -287,6 +288,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         persistant_default_layer_set(1UL<<_COLEMAK);
 
         key_combos[CB_SUPERDUPER].keys = superduper_combos[_COLEMAK];
+        combo_keys_changed();
         eeprom_update_byte(EECONFIG_SUPERDUPER_INDEX, _COLEMAK);
       }
       return false;
@@ -299,6 +301,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
         persistant_default_layer_set(1UL<<_QWOC);
 
         key_combos[CB_SUPERDUPER].keys = superduper_combos[_QWOC];
+        combo_keys_changed();
         eeprom_update_byte(EECONFIG_SUPERDUPER_INDEX, _QWOC);
       }
       return false;
@@ -404,12 +407,14 @@ void set_superduper_key_combos(void) {
     case _COLEMAK:
     case _QWOC:
       key_combos[CB_SUPERDUPER].keys = superduper_combos[layer];
+      combo_keys_changed();
       break;
   }
 }
 
 void clear_superduper_key_combos(void) {
   key_combos[CB_SUPERDUPER].keys = empty_combo;
+  combo_keys_changed();
 }
 
 void matrix_scan_user(void) {
@@ -444,7 +449,7 @@ void music_scale_user(void)
 
 // Combos
 
-void process_combo_event(uint8_t combo_index, bool pressed) {
+void process_combo_event(uint16_t combo_index, bool pressed) {
   if (pressed) {
     switch(combo_index) {
       case CB_SUPERDUPER:
@@ -0,0 +1,49 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+/* Set 0 if debouncing isn't needed */
+#ifndef DEBOUNCING_DELAY
+#   define DEBOUNCING_DELAY 5
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The debounce algorithm is selected with DEBOUNCE_TYPE in rules.mk, see
+ * quantum/debounce/ for the available ones.
+ *
+ * raw holds the switch states read in this scan and cooked the debounced
+ * states, which are updated in place. changed tells whether raw differs
+ * from the previous scan.
+ */
+void debounce_init(uint8_t num_rows);
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed);
+/* true while some change is still waiting to settle */
+bool debounce_active(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
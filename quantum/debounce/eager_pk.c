@@ -0,0 +1,106 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Eager press, deferred release, per key debounce
+ *
+ * A press is reported as soon as it is seen, after which the key ignores
+ * its switch for DEBOUNCING_DELAY ms, so that the bouncing doesn't release
+ * it again. A release is only reported once the switch has been open for
+ * DEBOUNCING_DELAY ms. This gives the lowest press latency, at the cost of
+ * reacting to noise on open switches. Uses one byte of RAM per key.
+ */
+
+#include "debounce.h"
+#include "timer.h"
+
+#if (DEBOUNCING_DELAY > 127)
+#   error "DEBOUNCING_DELAY can't be more than 127 ms with this debounce type"
+#endif
+
+/* the top bit of a countdown tells that it is a pending release */
+#define RELEASE_PENDING 0x80
+#define COUNTDOWN_MASK  0x7F
+
+static uint8_t countdown[MATRIX_ROWS][MATRIX_COLS];
+static bool counting = false;
+static uint16_t last_time;
+
+void debounce_init(uint8_t num_rows)
+{
+    for (uint8_t i = 0; i < num_rows; i++) {
+        for (uint8_t j = 0; j < MATRIX_COLS; j++) {
+            countdown[i][j] = 0;
+        }
+    }
+    counting = false;
+    last_time = timer_read();
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed)
+{
+    if (!changed && !counting) {
+        last_time = timer_read();
+        return;
+    }
+
+    uint16_t elapsed = timer_elapsed(last_time);
+    last_time += elapsed;
+
+    counting = false;
+    for (uint8_t i = 0; i < num_rows; i++) {
+        for (uint8_t j = 0; j < MATRIX_COLS; j++) {
+            matrix_row_t col_mask = (matrix_row_t)1 << j;
+            uint8_t *counter = &countdown[i][j];
+            bool is_raw = raw[i] & col_mask;
+
+            if (*counter) {
+                if ((*counter & COUNTDOWN_MASK) > elapsed) {
+                    *counter -= elapsed;
+                    // a pending release is cancelled when the switch closes again
+                    if ((*counter & RELEASE_PENDING) && is_raw) {
+                        *counter = 0;
+                    }
+                } else if (*counter & RELEASE_PENDING) {
+                    *counter = 0;
+                    cooked[i] &= ~col_mask;
+                } else {
+                    // the press lockout is over, look at the switch again below
+                    *counter = 0;
+                }
+            }
+            if (!*counter && (is_raw != !!(cooked[i] & col_mask))) {
+                if (is_raw) {
+                    cooked[i] |= col_mask;
+                    *counter = DEBOUNCING_DELAY;
+                } else {
+                    *counter = DEBOUNCING_DELAY | RELEASE_PENDING;
+                }
+#if (DEBOUNCING_DELAY == 0)
+                cooked[i] = (cooked[i] & ~col_mask) | (raw[i] & col_mask);
+                *counter = 0;
+#endif
+            }
+            if (*counter) {
+                counting = true;
+            }
+        }
+    }
+}
+
+bool debounce_active(void)
+{
+    return counting;
+}
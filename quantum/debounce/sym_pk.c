@@ -0,0 +1,89 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Symmetric, per key debounce
+ *
+ * Every key has its own timer, started when the key differs from its
+ * debounced state and cancelled when it bounces back. The key is updated
+ * once it has differed for DEBOUNCING_DELAY ms. Uses one byte of RAM per
+ * key.
+ */
+
+#include "debounce.h"
+#include "timer.h"
+
+#if (DEBOUNCING_DELAY > 255)
+#   error "DEBOUNCING_DELAY can't be more than 255 ms with this debounce type"
+#endif
+
+static uint8_t countdown[MATRIX_ROWS][MATRIX_COLS];
+static bool counting = false;
+static uint16_t last_time;
+
+void debounce_init(uint8_t num_rows)
+{
+    for (uint8_t i = 0; i < num_rows; i++) {
+        for (uint8_t j = 0; j < MATRIX_COLS; j++) {
+            countdown[i][j] = 0;
+        }
+    }
+    counting = false;
+    last_time = timer_read();
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed)
+{
+    if (!changed && !counting) {
+        last_time = timer_read();
+        return;
+    }
+
+    uint16_t elapsed = timer_elapsed(last_time);
+    last_time += elapsed;
+
+    counting = false;
+    for (uint8_t i = 0; i < num_rows; i++) {
+        matrix_row_t delta = raw[i] ^ cooked[i];
+        for (uint8_t j = 0; j < MATRIX_COLS; j++) {
+            matrix_row_t col_mask = (matrix_row_t)1 << j;
+            uint8_t *counter = &countdown[i][j];
+            if (!(delta & col_mask)) {
+                // stable, or bounced back before the timer ran out
+                *counter = 0;
+            } else if (!*counter) {
+                *counter = DEBOUNCING_DELAY;
+            } else if (*counter <= elapsed) {
+                *counter = 0;
+                cooked[i] ^= col_mask;
+            } else {
+                *counter -= elapsed;
+            }
+#if (DEBOUNCING_DELAY == 0)
+            if (delta & col_mask) {
+                cooked[i] ^= col_mask;
+            }
+#endif
+            if (*counter) {
+                counting = true;
+            }
+        }
+    }
+}
+
+bool debounce_active(void)
+{
+    return counting;
+}
@@ -0,0 +1,82 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Symmetric, per row debounce
+ *
+ * Every row has its own timer, which is restarted when the row changes. A
+ * row is only updated after it has been stable for DEBOUNCING_DELAY ms, so
+ * bouncing keys on one row don't delay the other rows.
+ */
+
+#include "debounce.h"
+#include "timer.h"
+
+#if (DEBOUNCING_DELAY > 255)
+#   error "DEBOUNCING_DELAY can't be more than 255 ms with this debounce type"
+#endif
+
+static matrix_row_t last_raw[MATRIX_ROWS];
+static uint8_t countdown[MATRIX_ROWS];
+static bool counting = false;
+static uint16_t last_time;
+
+void debounce_init(uint8_t num_rows)
+{
+    for (uint8_t i = 0; i < num_rows; i++) {
+        last_raw[i] = 0;
+        countdown[i] = 0;
+    }
+    counting = false;
+    last_time = timer_read();
+}
+
+void debounce(matrix_row_t raw[], matrix_row_t cooked[], uint8_t num_rows, bool changed)
+{
+    if (!changed && !counting) {
+        last_time = timer_read();
+        return;
+    }
+
+    uint16_t elapsed = timer_elapsed(last_time);
+    last_time += elapsed;
+
+    counting = false;
+    for (uint8_t i = 0; i < num_rows; i++) {
+        if (raw[i] != last_raw[i]) {
+            // (re)start the countdown, or cancel it if the row bounced back
+            last_raw[i] = raw[i];
+            countdown[i] = (raw[i] != cooked[i]) ? DEBOUNCING_DELAY : 0;
+            if (countdown[i] == 0) {
+                cooked[i] = raw[i];
+            }
+        } else if (countdown[i]) {
+            if (countdown[i] <= elapsed) {
+                countdown[i] = 0;
+                cooked[i] = raw[i];
+            } else {
+                countdown[i] -= elapsed;
+            }
+        }
+        if (countdown[i]) {
+            counting = true;
+        }
+    }
+}
+
+bool debounce_active(void)
+{
+    return counting;
+}
@@ -0,0 +1,35 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce_test_common.h"
+
+// These tests are run for the algorithms which wait for the switches to
+// settle before reporting a change
+
+TEST_F(DebounceTest, GlitchesAreIgnored) {
+    for (const auto& trace : noise_traces()) {
+        SetUp();
+        DebounceResult result = run_trace(trace);
+        EXPECT_EQ(result.missed, 0) << trace.name;
+        EXPECT_EQ(result.extra, 0) << trace.name;
+    }
+}
+
+TEST_F(DebounceTest, ChangesAreDelayed) {
+    DebounceTrace trace = {"single press", {{10, 0, 0, true}}, {{10, 0, 0, true}}};
+    DebounceResult result = run_trace(trace);
+    EXPECT_GE(result.max_latency, DEBOUNCING_DELAY);
+}
@@ -0,0 +1,175 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce_test_common.h"
+#include <algorithm>
+#include <stdio.h>
+
+// Events are only matched when reported this long after the switch changed
+#define MAX_MATCH_LATENCY 50
+
+namespace {
+    // The switch changes state at time, and then bounces for the given
+    // number of ms, toggling every ms
+    void add_bouncy_change(DebounceTrace& trace, uint32_t time, uint8_t row, uint8_t col, bool pressed, uint8_t bounce) {
+        trace.expected.push_back({time, row, col, pressed});
+        for (uint8_t i = 0; i <= bounce; i++) {
+            trace.raw.push_back({time + i, row, col, (i % 2 == 0) == pressed});
+        }
+        if (bounce % 2) {
+            trace.raw.push_back({time + bounce + 1, row, col, pressed});
+        }
+    }
+
+    void add_tap(DebounceTrace& trace, uint32_t time, uint32_t hold, uint8_t row, uint8_t col, uint8_t bounce) {
+        add_bouncy_change(trace, time, row, col, true, bounce);
+        add_bouncy_change(trace, time + hold, row, col, false, bounce);
+    }
+
+    void add_glitch(DebounceTrace& trace, uint32_t time, uint8_t row, uint8_t col, bool pressed) {
+        trace.raw.push_back({time, row, col, pressed});
+        trace.raw.push_back({time + 1, row, col, !pressed});
+    }
+
+    void sort_trace(DebounceTrace& trace) {
+        auto by_time = [](const SwitchChange& a, const SwitchChange& b) { return a.time < b.time; };
+        std::stable_sort(trace.raw.begin(), trace.raw.end(), by_time);
+        std::stable_sort(trace.expected.begin(), trace.expected.end(), by_time);
+    }
+}
+
+void DebounceTest::SetUp() {
+    set_time(0);
+    debounce_init(MATRIX_ROWS);
+}
+
+DebounceResult DebounceTest::run_trace(const DebounceTrace& trace) {
+    matrix_row_t raw[MATRIX_ROWS] = {};
+    matrix_row_t cooked[MATRIX_ROWS] = {};
+    std::vector<SwitchChange> actual;
+    uint32_t end = trace.raw.empty() ? 0 : trace.raw.back().time + MAX_MATCH_LATENCY;
+    size_t next = 0;
+
+    for (uint32_t t = 0; t <= end; t++) {
+        matrix_row_t before[MATRIX_ROWS];
+        std::copy(raw, raw + MATRIX_ROWS, before);
+        for (; next < trace.raw.size() && trace.raw[next].time == t; next++) {
+            const SwitchChange& c = trace.raw[next];
+            matrix_row_t mask = (matrix_row_t)1 << c.col;
+            raw[c.row] = c.pressed ? (raw[c.row] | mask) : (raw[c.row] & ~mask);
+        }
+        bool changed = !std::equal(raw, raw + MATRIX_ROWS, before);
+
+        matrix_row_t previous[MATRIX_ROWS];
+        std::copy(cooked, cooked + MATRIX_ROWS, previous);
+        debounce(raw, cooked, MATRIX_ROWS, changed);
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            matrix_row_t delta = previous[row] ^ cooked[row];
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                matrix_row_t mask = (matrix_row_t)1 << col;
+                if (delta & mask) {
+                    actual.push_back({t, row, col, (cooked[row] & mask) != 0});
+                }
+            }
+        }
+        advance_time(1);
+    }
+
+    DebounceResult result = {};
+    result.events = trace.expected.size();
+    std::vector<bool> used(actual.size(), false);
+    for (const SwitchChange& e : trace.expected) {
+        bool found = false;
+        for (size_t i = 0; i < actual.size(); i++) {
+            const SwitchChange& a = actual[i];
+            if (!used[i] && a.row == e.row && a.col == e.col && a.pressed == e.pressed &&
+                a.time >= e.time && a.time <= e.time + MAX_MATCH_LATENCY) {
+                used[i] = true;
+                found = true;
+                uint32_t latency = a.time - e.time;
+                result.total_latency += latency;
+                result.max_latency = std::max(result.max_latency, latency);
+                break;
+            }
+        }
+        if (!found) {
+            result.missed++;
+        }
+    }
+    result.extra = std::count(used.begin(), used.end(), false);
+
+    unsigned matched = result.events - result.missed;
+    printf("[ DEBOUNCE ] %s, %s: %u events, %u missed, %u extra, added latency avg %.1f max %u ms\n",
+        DEBOUNCE_TYPE_NAME, trace.name, result.events, result.missed, result.extra,
+        matched ? (double)result.total_latency / matched : 0.0, result.max_latency);
+    return result;
+}
+
+std::vector<DebounceTrace> DebounceTest::bouncy_traces() {
+    std::vector<DebounceTrace> traces;
+
+    DebounceTrace clean = {"clean tap"};
+    add_tap(clean, 10, 50, 0, 0, 0);
+    traces.push_back(clean);
+
+    DebounceTrace bouncy = {"bouncy tap"};
+    add_tap(bouncy, 10, 60, 1, 2, 3);
+    traces.push_back(bouncy);
+
+    DebounceTrace roll = {"roll across rows"};
+    add_tap(roll, 10, 40, 0, 0, 2);
+    add_tap(roll, 25, 40, 1, 3, 3);
+    add_tap(roll, 45, 40, 2, 5, 1);
+    add_tap(roll, 70, 40, 3, 9, 4);
+    traces.push_back(roll);
+
+    DebounceTrace same_row = {"roll on one row"};
+    add_tap(same_row, 10, 30, 2, 0, 3);
+    add_tap(same_row, 22, 30, 2, 1, 4);
+    add_tap(same_row, 34, 30, 2, 2, 2);
+    add_tap(same_row, 46, 30, 2, 3, 3);
+    traces.push_back(same_row);
+
+    // 120 wpm with a lot of overlap between the keys
+    DebounceTrace fast = {"fast typing"};
+    for (uint8_t i = 0; i < 20; i++) {
+        add_tap(fast, 10 + i * 20, 45, i % MATRIX_ROWS, (i * 3) % MATRIX_COLS, i % 5);
+    }
+    traces.push_back(fast);
+
+    for (auto& trace : traces) {
+        sort_trace(trace);
+    }
+    return traces;
+}
+
+std::vector<DebounceTrace> DebounceTest::noise_traces() {
+    std::vector<DebounceTrace> traces;
+
+    DebounceTrace idle = {"glitch on open switch"};
+    add_glitch(idle, 20, 0, 4, true);
+    traces.push_back(idle);
+
+    DebounceTrace held = {"glitch on held switch"};
+    add_tap(held, 10, 80, 1, 1, 0);
+    add_glitch(held, 40, 1, 1, false);
+    traces.push_back(held);
+
+    for (auto& trace : traces) {
+        sort_trace(trace);
+    }
+    return traces;
+}
@@ -0,0 +1,68 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "gtest/gtest.h"
+#include <vector>
+
+extern "C" {
+#include "debounce.h"
+#include "timer.h"
+void set_time(uint32_t t);
+void advance_time(uint32_t ms);
+}
+
+#define DEBOUNCE_STR2(x) #x
+#define DEBOUNCE_STR(x) DEBOUNCE_STR2(x)
+#define DEBOUNCE_TYPE_NAME DEBOUNCE_STR(DEBOUNCE_TYPE)
+
+// A change of one switch, at a time in ms
+struct SwitchChange {
+    uint32_t time;
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+};
+
+// A recorded switch trace, together with the key events a perfect debouncer
+// would report for it
+struct DebounceTrace {
+    const char* name;
+    std::vector<SwitchChange> raw;
+    std::vector<SwitchChange> expected;
+};
+
+struct DebounceResult {
+    unsigned events;
+    unsigned missed;
+    unsigned extra;
+    uint32_t total_latency;
+    uint32_t max_latency;
+};
+
+class DebounceTest : public testing::Test {
+protected:
+    void SetUp() override;
+    // Plays the trace, with one scan per ms, and compares the debounced
+    // events with the expected ones
+    DebounceResult run_trace(const DebounceTrace& trace);
+
+    // Traces where every switch bounces for less than DEBOUNCING_DELAY
+    static std::vector<DebounceTrace> bouncy_traces();
+    // Traces with short glitches on otherwise stable switches
+    static std::vector<DebounceTrace> noise_traces();
+};
@@ -0,0 +1,57 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "debounce_test_common.h"
+#include <algorithm>
+
+// These tests are run for all the debounce algorithms
+
+TEST_F(DebounceTest, BouncyTracesHaveNoMissedOrExtraEvents) {
+    for (const auto& trace : bouncy_traces()) {
+        SetUp();
+        DebounceResult result = run_trace(trace);
+        EXPECT_EQ(result.missed, 0) << trace.name;
+        EXPECT_EQ(result.extra, 0) << trace.name;
+    }
+}
+
+TEST_F(DebounceTest, SingleKeyLatencyIsBounded) {
+    for (const auto& trace : bouncy_traces()) {
+        bool single_key = std::all_of(trace.expected.begin(), trace.expected.end(), [&](const SwitchChange& e) {
+            return e.row == trace.expected[0].row && e.col == trace.expected[0].col;
+        });
+        if (!single_key) {
+            continue;
+        }
+        SetUp();
+        DebounceResult result = run_trace(trace);
+        // No algorithm should wait for much more than the bounce and the delay
+        EXPECT_LE(result.max_latency, 2 * DEBOUNCING_DELAY + 1) << trace.name;
+    }
+}
+
+TEST_F(DebounceTest, NothingIsReportedWithoutChanges) {
+    matrix_row_t raw[MATRIX_ROWS] = {};
+    matrix_row_t cooked[MATRIX_ROWS] = {};
+    for (int i = 0; i < 100; i++) {
+        debounce(raw, cooked, MATRIX_ROWS, false);
+        advance_time(1);
+    }
+    for (int i = 0; i < MATRIX_ROWS; i++) {
+        EXPECT_EQ(cooked[i], 0);
+    }
+    EXPECT_FALSE(debounce_active());
+}
@@ -0,0 +1,26 @@
+DEBOUNCE_COMMON_DEFS := -DMATRIX_ROWS=4 -DMATRIX_COLS=10 -DDEBOUNCING_DELAY=5
+
+DEBOUNCE_COMMON_SRC := \
+	$(QUANTUM_PATH)/debounce/tests/debounce_test_common.cpp \
+	$(QUANTUM_PATH)/debounce/tests/debounce_tests.cpp \
+	$(TMK_PATH)/common/test/timer.c
+
+debounce_sym_g_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_TYPE=sym_g
+debounce_sym_g_SRC := $(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/tests/debounce_deferred_tests.cpp \
+	$(QUANTUM_PATH)/debounce/sym_g.c
+
+debounce_sym_pr_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_TYPE=sym_pr
+debounce_sym_pr_SRC := $(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/tests/debounce_deferred_tests.cpp \
+	$(QUANTUM_PATH)/debounce/sym_pr.c
+
+debounce_sym_pk_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_TYPE=sym_pk
+debounce_sym_pk_SRC := $(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/tests/debounce_deferred_tests.cpp \
+	$(QUANTUM_PATH)/debounce/sym_pk.c
+
+debounce_eager_pk_DEFS := $(DEBOUNCE_COMMON_DEFS) -DDEBOUNCE_TYPE=eager_pk
+debounce_eager_pk_SRC := $(DEBOUNCE_COMMON_SRC) \
+	$(QUANTUM_PATH)/debounce/tests/debounce_eager_tests.cpp \
+	$(QUANTUM_PATH)/debounce/eager_pk.c
@@ -0,0 +1,5 @@
+TEST_LIST +=\
+	debounce_sym_g\
+	debounce_sym_pr\
+	debounce_sym_pk\
+	debounce_eager_pk
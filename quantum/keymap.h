@@ -52,5 +52,10 @@ uint16_t keymap_function_id_to_action( uint16_t function_id );
 extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
 extern const uint16_t fn_actions[];
 
+#ifdef ACTION_CACHE_LAYERS
+// forgets the decoded actions, for keymaps that change their keycodes
+void action_cache_clear(void);
+#endif
+
 
 #endif
@@ -40,13 +40,55 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 extern keymap_config_t keymap_config;
 
 #include <inttypes.h>
+#include <string.h>
+
+#ifdef ACTION_CACHE_LAYERS
+/* The decoded actions of the lowest layers, filled as the keys are used.
+ * The decoding depends on keymap_config, so they are thrown away when it
+ * changes.
+ */
+static action_t action_cache[ACTION_CACHE_LAYERS][MATRIX_ROWS][MATRIX_COLS];
+static matrix_row_t action_cache_valid[ACTION_CACHE_LAYERS][MATRIX_ROWS];
+static uint16_t action_cache_config = 0;
+
+void action_cache_clear(void)
+{
+    memset(action_cache_valid, 0, sizeof(action_cache_valid));
+    action_cache_config = keymap_config.raw;
+}
+#endif
 
 /* converts key to action */
 action_t action_for_key(uint8_t layer, keypos_t key)
 {
+#ifdef ACTION_CACHE_LAYERS
+    if (layer < ACTION_CACHE_LAYERS && key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        matrix_row_t col_mask = (matrix_row_t)1 << key.col;
+        if (keymap_config.raw != action_cache_config) {
+            action_cache_clear();
+        }
+        if (action_cache_valid[layer][key.row] & col_mask) {
+            return action_cache[layer][key.row][key.col];
+        }
+        action_t action = action_for_keycode(keymap_key_to_keycode(layer, key));
+    #if defined(BACKLIGHT_ENABLE) && defined(SPLIT_KEYBOARD)
+        // the lookup itself tells the other half about the backlight
+        if (action.kind.id == ACT_BACKLIGHT) {
+            return action;
+        }
+    #endif
+        action_cache[layer][key.row][key.col] = action;
+        action_cache_valid[layer][key.row] |= col_mask;
+        return action;
+    }
+#endif
     // 16bit keycodes - important
-    uint16_t keycode = keymap_key_to_keycode(layer, key);
+    return action_for_keycode(keymap_key_to_keycode(layer, key));
+}
 
+/* converts keycode to action */
+action_t action_for_keycode(uint16_t keycode)
+{
     // keycode remapping
     keycode = keycode_config(keycode);
 
@@ -204,13 +246,15 @@ void action_function(keyrecord_t *record, uint8_t id, uint8_t opt)
 {
 }
 
-// translates key to keycode
+#ifndef SPARSE_KEYMAP_ENABLE
+// translates key to keycode, the sparse keymap has its own
 __attribute__ ((weak))
 uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key)
 {
     // Read entire word (16bits)
     return pgm_read_word(&keymaps[(layer)][(key.row)][(key.col)]);
 }
+#endif
 
 // translates function id to action
 __attribute__ ((weak))
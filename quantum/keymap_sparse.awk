@@ -0,0 +1,80 @@
+# Copyright 2018 QMK
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# Turns the keymaps array of a compiled keymap into the tables of
+# quantum/keymap_sparse.c. The input is the array as hex bytes, as printed
+# by od -tx1, with the keycodes in little endian order like on AVR and ARM.
+
+function hex(s,    i, n) {
+    n = 0
+    for (i = 1; i <= length(s); i++)
+        n = n * 16 + index("0123456789abcdef", tolower(substr(s, i, 1))) - 1
+    return n
+}
+
+function print_array(name, values, count,    i, line) {
+    printf "const uint16_t PROGMEM %s[] = {\n", name
+    if (count == 0)
+        values[count++] = "0x0000"
+    line = "   "
+    for (i = 0; i < count; i++) {
+        line = line " " values[i] ","
+        if (i % 8 == 7 || i == count - 1) {
+            print line
+            line = "   "
+        }
+    }
+    print "};"
+}
+
+{
+    for (i = 1; i <= NF; i++)
+        bytes[byte_count++] = hex($i)
+}
+
+END {
+    if (byte_count == 0 || byte_count % 2) {
+        print "keymap_sparse.awk: the keymaps array wasn't found" > "/dev/stderr"
+        exit 1
+    }
+    keys = byte_count / 2
+    words = int((keys + 15) / 16)
+    stored = 0
+    for (w = 0; w < words; w++) {
+        bitmap = 0
+        rank[w] = sprintf("%d", stored)
+        for (b = 0; b < 16 && w * 16 + b < keys; b++) {
+            k = w * 16 + b
+            keycode = bytes[2 * k] + bytes[2 * k + 1] * 256
+            # KC_TRNS
+            if (keycode != 1) {
+                bitmap += 2 ^ b
+                keycodes[stored++] = sprintf("0x%04X", keycode)
+            }
+        }
+        bitmaps[w] = sprintf("0x%04X", bitmap)
+    }
+
+    print "/* Generated from the keymaps array by quantum/keymap_sparse.awk, don't edit"
+    printf " *\n * %d keys, %d of them stored\n", keys, stored
+    printf " * dense: %d bytes, sparse: %d bytes\n */\n\n", keys * 2, 2 + words * 4 + (stored ? stored : 1) * 2
+    print "#include \"keymap_sparse.h\"\n"
+    printf "const uint16_t PROGMEM keymap_sparse_size = %d;\n\n", keys
+    print_array("keymap_sparse_bitmap", bitmaps, words)
+    print ""
+    print_array("keymap_sparse_rank", rank, words)
+    print ""
+    print_array("keymap_sparse_keycodes", keycodes, stored)
+}
@@ -0,0 +1,41 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "keymap_sparse.h"
+#include "keymap.h"
+#include "util.h"
+
+static uint16_t keymap_sparse_index(uint8_t layer, keypos_t key)
+{
+    return ((uint16_t)layer * MATRIX_ROWS + key.row) * MATRIX_COLS + key.col;
+}
+
+// translates key to keycode, the layers past the end of the keymap are transparent
+__attribute__ ((weak))
+uint16_t keymap_key_to_keycode(uint8_t layer, keypos_t key)
+{
+    uint16_t index = keymap_sparse_index(layer, key);
+    if (index >= pgm_read_word(&keymap_sparse_size)) {
+        return KC_TRNS;
+    }
+    uint16_t bitmap = pgm_read_word(&keymap_sparse_bitmap[index / 16]);
+    uint16_t bit = 1U << (index % 16);
+    if (!(bitmap & bit)) {
+        return KC_TRNS;
+    }
+    uint16_t rank = pgm_read_word(&keymap_sparse_rank[index / 16]) + bitpop16(bitmap & (bit - 1));
+    return pgm_read_word(&keymap_sparse_keycodes[rank]);
+}
@@ -0,0 +1,45 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KEYMAP_SPARSE_H
+#define KEYMAP_SPARSE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "progmem.h"
+#include "keyboard.h"
+
+/*
+ * Sparse keymap storage, see SPARSE_KEYMAP_ENABLE.
+ *
+ * The keys of all the layers are numbered in the order of the keymaps
+ * array, layer by layer and row by row. Only the keys that aren't KC_TRNS
+ * are stored, in keymap_sparse_keycodes. Every 16 keys have a bitmap of the
+ * ones that are stored, and the number of stored keys before them:
+ *
+ *   keycode = keycodes[rank[n / 16] + bits of bitmap[n / 16] below n]
+ *
+ * The tables are generated at build time from the compiled keymaps array
+ * by keymap_sparse.awk, so the keymap itself doesn't change.
+ */
+
+// the number of keys in all the layers
+extern const uint16_t PROGMEM keymap_sparse_size;
+extern const uint16_t PROGMEM keymap_sparse_bitmap[];
+extern const uint16_t PROGMEM keymap_sparse_rank[];
+extern const uint16_t PROGMEM keymap_sparse_keycodes[];
+
+#endif
@@ -16,9 +16,10 @@
 
 #include "process_combo.h"
 #include "print.h"
+#include "deferred.h"
 
 
-#define COMBO_TIMER_ELAPSED -1
+#define COMBO_TIMER_ELAPSED ((uint16_t)-1)
 
 
 __attribute__ ((weak))
@@ -27,11 +28,144 @@ combo_t key_combos[COMBO_COUNT] = {
 };
 
 __attribute__ ((weak))
-void process_combo_event(uint8_t combo_index, bool pressed) {
+void process_combo_event(uint16_t combo_index, bool pressed) {
 
 }
 
-static uint8_t current_combo_index = 0;
+static uint16_t current_combo_index = 0;
+
+/* Lookup index from keycode to the combos using it, sorted by keycode and
+ * built on first use. An entry holds the combo and the position of the key
+ * in it, the keycode itself is read from the PROGMEM key list. Combos from
+ * unindexed_combos onwards didn't fit and are scanned linearly instead.
+ */
+#if COMBO_INDEX_SIZE > 0
+#if COMBO_COUNT > (0x10000 >> COMBO_KEY_BITS)
+#error "Too many combos for the combo index, define COMBO_INDEX_SIZE 0"
+#endif
+typedef uint16_t combo_index_entry_t;
+#define COMBO_INDEX_ENTRY(combo, key)   (((combo) << COMBO_KEY_BITS) | (key))
+#define COMBO_INDEX_COMBO(entry)        ((entry) >> COMBO_KEY_BITS)
+#define COMBO_INDEX_KEY(entry)          ((entry) & ((1 << COMBO_KEY_BITS) - 1))
+
+static combo_index_entry_t combo_index[COMBO_INDEX_SIZE];
+static uint16_t combo_index_count = 0;
+static uint16_t unindexed_combos = 0;
+#else
+#define unindexed_combos 0
+#endif
+static bool combos_ready = false;
+
+/* Combos with a running timer, one bit each, the only ones combo_timeout()
+ * looks at
+ */
+static uint8_t timed_combos[(COMBO_COUNT + 7) / 8];
+static deferred_token_t combo_token = DEFERRED_TOKEN_NONE;
+
+static void combo_timeout(void *arg);
+
+static inline combo_t *get_combo(uint16_t index)
+{
+    // Do not treat the (weak) key_combos too strict.
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Warray-bounds"
+    return &key_combos[index];
+    #pragma GCC diagnostic pop
+}
+
+#if COMBO_INDEX_SIZE > 0
+static inline uint16_t combo_index_keycode(combo_index_entry_t entry)
+{
+    return pgm_read_word(&get_combo(COMBO_INDEX_COMBO(entry))->keys[COMBO_INDEX_KEY(entry)]);
+}
+
+static uint16_t combo_index_lower_bound(uint16_t keycode)
+{
+    uint16_t lo = 0;
+    uint16_t hi = combo_index_count;
+    while (lo < hi) {
+        uint16_t mid = lo + (hi - lo) / 2;
+        if (combo_index_keycode(combo_index[mid]) < keycode) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void combo_index_insert(uint16_t keycode, uint16_t combo, uint8_t key)
+{
+    /* Keep entries with the same keycode in combo order, so that combos are
+     * processed in the same order as the key_combos array
+     */
+    uint16_t pos = combo_index_count;
+    while (pos > 0 && combo_index_keycode(combo_index[pos - 1]) > keycode) {
+        combo_index[pos] = combo_index[pos - 1];
+        --pos;
+    }
+    combo_index[pos] = COMBO_INDEX_ENTRY(combo, key);
+    ++combo_index_count;
+}
+
+static void build_combo_index(void)
+{
+    combo_index_count = 0;
+    unindexed_combos = COMBO_COUNT;
+
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+        const uint16_t *keys = get_combo(i)->keys;
+        uint8_t count = get_combo(i)->key_count;
+
+        if (combo_index_count + count > COMBO_INDEX_SIZE) {
+            unindexed_combos = i;
+            break;
+        }
+        for (uint8_t key = 0; key < count; ++key) {
+            uint16_t keycode = pgm_read_word(&keys[key]);
+            /* A keycode repeated within a combo maps to its last position */
+            bool found = false;
+            for (uint16_t e = combo_index_lower_bound(keycode);
+                 e < combo_index_count && combo_index_keycode(combo_index[e]) == keycode; ++e) {
+                if (COMBO_INDEX_COMBO(combo_index[e]) == i) {
+                    combo_index[e] = COMBO_INDEX_ENTRY(i, key);
+                    found = true;
+                }
+            }
+            if (!found) combo_index_insert(keycode, i, key);
+        }
+    }
+}
+#endif
+
+/* Counts the keys of the combos that weren't declared with COMBO() or
+ * COMBO_ACTION(), or whose array is longer than its keys, and builds the
+ * index
+ */
+static void init_combos(void)
+{
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+        combo_t *combo = get_combo(i);
+        if (!combo->key_count
+            || COMBO_END == pgm_read_word(&combo->keys[combo->key_count - 1])
+            || COMBO_END != pgm_read_word(&combo->keys[combo->key_count])) {
+            combo->key_count = 0;
+            while (COMBO_END != pgm_read_word(&combo->keys[combo->key_count])) ++combo->key_count;
+        }
+    }
+#if COMBO_INDEX_SIZE > 0
+    build_combo_index();
+#endif
+    combos_ready = true;
+}
+
+void combo_keys_changed(void)
+{
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+        get_combo(i)->key_count = 0;
+    }
+    combos_ready = false;
+}
 
 static inline void send_combo(uint16_t action, bool pressed)
 {
@@ -46,24 +180,24 @@ static inline void send_combo(uint16_t action, bool pressed)
     }
 }
 
-#define ALL_COMBO_KEYS_ARE_DOWN     (((1<<count)-1) == combo->state)
+static inline void start_combo_timer(combo_t *combo)
+{
+    combo->timer = timer_read();
+    timed_combos[current_combo_index / 8] |= 1 << (current_combo_index % 8);
+    /* Restarting a timer only moves its deadline later, so a pending
+     * callback is still early enough
+     */
+    if (combo_token == DEFERRED_TOKEN_NONE) {
+        combo_token = deferred_add_reserved(COMBO_TERM + 1, combo_timeout, NULL);
+    }
+}
+
+#define ALL_COMBO_KEYS_ARE_DOWN     ((combo_state_t)((1 << combo->key_count) - 1) == combo->state)
 #define NO_COMBO_KEYS_ARE_DOWN      (0 == combo->state)
 #define KEY_STATE_DOWN(key)         do{ combo->state |= (1<<key); } while(0)
 #define KEY_STATE_UP(key)           do{ combo->state &= ~(1<<key); } while(0)
-static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) 
+static bool process_single_combo(combo_t *combo, uint8_t index, uint16_t keycode, keyrecord_t *record) 
 {
-    uint8_t count = 0;
-    uint8_t index = -1;
-    /* Find index of keycode and number of combo keys */
-    for (const uint16_t *keys = combo->keys; ;++count) {
-        uint16_t key = pgm_read_word(&keys[count]);
-        if (keycode == key) index = count;
-        if (COMBO_END == key) break;
-    }
-
-    /* Return if not a combo key */
-    if (-1 == (int8_t)index) return false;
-
     /* The combos timer is used to signal whether the combo is active */
     bool is_combo_active = COMBO_TIMER_ELAPSED == combo->timer ? false : true;
 
@@ -75,7 +209,7 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
                 send_combo(combo->keycode, true);
                 combo->timer = COMBO_TIMER_ELAPSED;
             } else { /* Combo key was pressed */
-                combo->timer = timer_read();
+                start_combo_timer(combo);
 #ifdef COMBO_ALLOW_ACTION_KEYS
                 combo->prev_record = *record;
 #else
@@ -116,39 +250,78 @@ bool process_combo(uint16_t keycode, keyrecord_t *record)
 {
     bool is_combo_key = false;
 
-    for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
-        combo_t *combo = &key_combos[current_combo_index];
-        is_combo_key |= process_single_combo(combo, keycode, record);
-    }    
+    if (!combos_ready) init_combos();
+
+#if COMBO_INDEX_SIZE > 0
+    for (uint16_t e = combo_index_lower_bound(keycode);
+         e < combo_index_count && combo_index_keycode(combo_index[e]) == keycode; ++e) {
+        current_combo_index = COMBO_INDEX_COMBO(combo_index[e]);
+        is_combo_key |= process_single_combo(get_combo(current_combo_index), COMBO_INDEX_KEY(combo_index[e]), keycode, record);
+    }
+#endif
+
+    for (current_combo_index = unindexed_combos; current_combo_index < COMBO_COUNT; ++current_combo_index) {
+        combo_t *combo = get_combo(current_combo_index);
+        uint8_t index = -1;
+        /* Find index of keycode */
+        for (uint8_t count = 0; count < combo->key_count; ++count) {
+            if (keycode == pgm_read_word(&combo->keys[count])) index = count;
+        }
+        if (-1 != (int8_t)index) {
+            is_combo_key |= process_single_combo(combo, index, keycode, record);
+        }
+    }
 
     return !is_combo_key;
 }
 
-void matrix_scan_combo(void)
+static void combo_timeout(void *arg)
 {
-    for (int i = 0; i < COMBO_COUNT; ++i) {
-        // Do not treat the (weak) key_combos too strict.
-        #pragma GCC diagnostic push
-        #pragma GCC diagnostic ignored "-Warray-bounds"
-        combo_t *combo = &key_combos[i];
-        #pragma GCC diagnostic pop
-        if (combo->timer &&
-            combo->timer != COMBO_TIMER_ELAPSED && 
-            timer_elapsed(combo->timer) > COMBO_TERM) {
-            
-            /* This disables the combo, meaning key events for this
-             * combo will be handled by the next processors in the chain 
-             */
-            combo->timer = COMBO_TIMER_ELAPSED;
+    bool kept = false;
+    uint16_t time_left = COMBO_TERM + 1;
+
+    combo_token = DEFERRED_TOKEN_NONE;
+
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+        uint8_t bit = 1 << (i % 8);
+        if (!(timed_combos[i / 8] & bit)) {
+            /* skip a whole byte of combos without timers at once */
+            if (!timed_combos[i / 8]) i |= 7;
+            continue;
+        }
+        current_combo_index = i;
+        combo_t *combo = get_combo(current_combo_index);
+
+        if (!combo->timer || combo->timer == COMBO_TIMER_ELAPSED) {
+            timed_combos[i / 8] &= ~bit;
+            continue;
+        }
+        uint16_t elapsed = timer_elapsed(combo->timer);
+        if (elapsed <= COMBO_TERM) {
+            kept = true;
+            if (COMBO_TERM + 1 - elapsed < time_left) {
+                time_left = COMBO_TERM + 1 - elapsed;
+            }
+            continue;
+        }
+
+        /* This disables the combo, meaning key events for this
+         * combo will be handled by the next processors in the chain 
+         */
+        combo->timer = COMBO_TIMER_ELAPSED;
+        timed_combos[i / 8] &= ~bit;
 
 #ifdef COMBO_ALLOW_ACTION_KEYS
-            process_action(&combo->prev_record, 
-                store_or_get_action(combo->prev_record.event.pressed, 
-                                    combo->prev_record.event.key));
+        process_action(&combo->prev_record, 
+            store_or_get_action(combo->prev_record.event.pressed, 
+                                combo->prev_record.event.key));
 #else
-            unregister_code16(combo->prev_key);
-            register_code16(combo->prev_key);
+        unregister_code16(combo->prev_key);
+        register_code16(combo->prev_key);
 #endif
-        }
+    }
+
+    if (kept) {
+        combo_token = deferred_add_reserved(time_left, combo_timeout, NULL);
     }
 }
@@ -20,18 +20,26 @@
 #include <stdint.h>
 #include "progmem.h"
 #include "quantum.h"
+#include "action_tapping.h"
 
-typedef struct
-{
-    const uint16_t *keys;
-    uint16_t keycode;        
 #ifdef EXTRA_EXTRA_LONG_COMBOS
-    uint32_t state;
+typedef uint32_t combo_state_t;
+#define COMBO_KEY_BITS 5
 #elif EXTRA_LONG_COMBOS
-    uint16_t state;
+typedef uint16_t combo_state_t;
+#define COMBO_KEY_BITS 4
 #else
-    uint8_t state;
+typedef uint8_t combo_state_t;
+#define COMBO_KEY_BITS 3
 #endif
+
+typedef struct
+{
+    const uint16_t *keys;
+    uint16_t keycode;        
+    /* set by COMBO() and COMBO_ACTION(), checked or counted on first use */
+    uint8_t key_count;
+    combo_state_t state;
     uint16_t timer;
 #ifdef COMBO_ALLOW_ACTION_KEYS
     keyrecord_t prev_record;
@@ -41,8 +49,12 @@ typedef struct
 } combo_t;
 
 
-#define COMBO(ck, ca)       {.keys = &(ck)[0], .keycode = (ca)}
-#define COMBO_ACTION(ck)    {.keys = &(ck)[0]}
+/* The number of keys before COMBO_END, when ck is an array and not a pointer */
+#define COMBO_KEY_COUNT(ck) \
+    (__builtin_types_compatible_p(__typeof__(ck), __typeof__(&(ck)[0])) ? 0 : sizeof(ck) / sizeof((ck)[0]) - 1)
+
+#define COMBO(ck, ca)       {.keys = &(ck)[0], .keycode = (ca), .key_count = COMBO_KEY_COUNT(ck)}
+#define COMBO_ACTION(ck)    {.keys = &(ck)[0], .key_count = COMBO_KEY_COUNT(ck)}
 
 #define COMBO_END 0
 #ifndef COMBO_COUNT
@@ -51,9 +63,24 @@ typedef struct
 #ifndef COMBO_TERM
 #define COMBO_TERM TAPPING_TERM
 #endif
+/* Number of keycode entries in the combo lookup index, ideally the total
+ * number of keys of all combos. Combos that don't fit are still handled,
+ * but by scanning them on every key event. The index is built in RAM, two
+ * bytes per entry, so on AVR it holds at most 64 keys by default.
+ */
+#ifndef COMBO_INDEX_SIZE
+#   if defined(__AVR__) && COMBO_COUNT * 3 > 64
+#       define COMBO_INDEX_SIZE 64
+#   else
+#       define COMBO_INDEX_SIZE (COMBO_COUNT * 3)
+#   endif
+#endif
 
 bool process_combo(uint16_t keycode, keyrecord_t *record);
-void matrix_scan_combo(void);
-void process_combo_event(uint8_t combo_index, bool pressed);
+void process_combo_event(uint16_t combo_index, bool pressed);
+/* Call after pointing a combo at other keys, the index and key counts
+ * are rebuilt on the next key event
+ */
+void combo_keys_changed(void);
 
 #endif
@@ -17,6 +17,7 @@
 #ifndef DISABLE_LEADER
 
 #include "process_leader.h"
+#include "deferred.h"
 
 #ifndef LEADER_TIMEOUT
   #define LEADER_TIMEOUT 300
@@ -35,9 +36,127 @@ uint16_t leader_time = 0;
 uint16_t leader_sequence[5] = {0, 0, 0, 0, 0};
 uint8_t leader_sequence_size = 0;
 
+#if LEADER_SEQUENCE_COUNT > 0
+#ifndef DEFERRED_ENABLE
+#error "Leader sequences need DEFERRED_ENABLE = yes in rules.mk"
+#endif
+
+__attribute__ ((weak))
+void process_leader_event(uint16_t seq_index) {}
+
+// Range of leader_sequences starting with the keys typed so far
+static uint16_t leader_seq_first = 0;
+static uint16_t leader_seq_last = 0;
+static uint8_t leader_seq_depth = 0;
+static deferred_token_t leader_seq_token = DEFERRED_TOKEN_NONE;
+
+static inline const uint16_t *leader_seq_keys(uint16_t index) {
+#if defined(__AVR__)
+  return (const uint16_t *)pgm_read_word(&leader_sequences[index].keys);
+#else
+  return leader_sequences[index].keys;
+#endif
+}
+
+static inline uint16_t leader_seq_key(uint16_t index, uint8_t depth) {
+  return pgm_read_word(&leader_seq_keys(index)[depth]);
+}
+
+bool leader_sequences_sorted(void) {
+  for (uint16_t i = 1; i < LEADER_SEQUENCE_COUNT; i++) {
+    for (uint8_t depth = 0; ; depth++) {
+      uint16_t prev = leader_seq_key(i - 1, depth);
+      uint16_t key = leader_seq_key(i, depth);
+      if (prev < key) {
+        break;
+      }
+      // out of order, or the same sequence twice
+      if (prev > key || key == KC_NO) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+static void leader_seq_finish(bool matched) {
+  deferred_cancel(leader_seq_token);
+  leader_seq_token = DEFERRED_TOKEN_NONE;
+  leading = false;
+  leader_end();
+  if (matched) {
+    uint16_t keycode = pgm_read_word(&leader_sequences[leader_seq_first].keycode);
+    if (keycode) {
+      register_code16(keycode);
+      unregister_code16(keycode);
+    } else {
+      process_leader_event(leader_seq_first);
+    }
+  }
+}
+
+// Whether the first sequence in the range has been typed completely
+static inline bool leader_seq_complete(void) {
+  return leader_seq_first < leader_seq_last &&
+    leader_seq_key(leader_seq_first, leader_seq_depth) == KC_NO;
+}
+
+static void leader_seq_advance(uint16_t keycode) {
+  // KC_NO ends the key lists, so it can't be part of a sequence
+  if (keycode == KC_NO) {
+    leader_seq_finish(false);
+    return;
+  }
+
+  uint16_t lo = leader_seq_first;
+  uint16_t hi = leader_seq_last;
+
+  // Narrow the range down to the sequences with keycode at this depth
+  while (lo < hi) {
+    uint16_t mid = lo + (hi - lo) / 2;
+    if (leader_seq_key(mid, leader_seq_depth) < keycode) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  leader_seq_first = lo;
+  hi = leader_seq_last;
+  while (lo < hi) {
+    uint16_t mid = lo + (hi - lo) / 2;
+    if (leader_seq_key(mid, leader_seq_depth) <= keycode) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  leader_seq_last = lo;
+  leader_seq_depth++;
+
+  if (leader_seq_first == leader_seq_last) {
+    leader_seq_finish(false);
+  } else if (leader_seq_last - leader_seq_first == 1 && leader_seq_complete()) {
+    leader_seq_finish(true);
+  }
+}
+
+static void leader_seq_timeout(void *arg) {
+  leader_seq_token = DEFERRED_TOKEN_NONE;
+  if (leading) {
+    leader_seq_finish(leader_seq_complete());
+  }
+}
+#endif
+
 bool process_leader(uint16_t keycode, keyrecord_t *record) {
   // Leader key set-up
   if (record->event.pressed) {
+#if LEADER_SEQUENCE_COUNT > 0
+    // The timeout has passed without its callback, end the sequence now
+    if (leading && leader_seq_token == DEFERRED_TOKEN_NONE && timer_elapsed(leader_time) >= LEADER_TIMEOUT) {
+      leader_seq_finish(leader_seq_complete());
+    }
+#endif
     if (!leading && keycode == KC_LEAD) {
       leader_start();
       leading = true;
@@ -48,11 +167,32 @@ bool process_leader(uint16_t keycode, keyrecord_t *record) {
       leader_sequence[2] = 0;
       leader_sequence[3] = 0;
       leader_sequence[4] = 0;
+#if LEADER_SEQUENCE_COUNT > 0
+#ifdef CONSOLE_ENABLE
+      static bool leader_seq_checked = false;
+      if (!leader_seq_checked) {
+        leader_seq_checked = true;
+        if (!leader_sequences_sorted()) {
+          print("leader_sequences isn't sorted, some sequences won't be found\n");
+        }
+      }
+#endif
+      leader_seq_first = 0;
+      leader_seq_last = LEADER_SEQUENCE_COUNT;
+      leader_seq_depth = 0;
+      deferred_cancel(leader_seq_token);
+      leader_seq_token = deferred_add_reserved(LEADER_TIMEOUT + 1, leader_seq_timeout, NULL);
+#endif
       return false;
     }
     if (leading && timer_elapsed(leader_time) < LEADER_TIMEOUT) {
-      leader_sequence[leader_sequence_size] = keycode;
-      leader_sequence_size++;
+      if (leader_sequence_size < sizeof(leader_sequence) / sizeof(leader_sequence[0])) {
+        leader_sequence[leader_sequence_size] = keycode;
+        leader_sequence_size++;
+      }
+#if LEADER_SEQUENCE_COUNT > 0
+      leader_seq_advance(keycode);
+#endif
       return false;
     }
   }
@@ -25,6 +25,40 @@ bool process_leader(uint16_t keycode, keyrecord_t *record);
 void leader_start(void);
 void leader_end(void);
 
+/* Declarative leader sequences
+ *
+ * Instead of the SEQ_*_KEYS macros, a keymap can define LEADER_SEQUENCE_COUNT
+ * and a PROGMEM leader_sequences table. The key lists end with KC_NO and can
+ * have any length. The table is a flattened trie, so it must be sorted by the
+ * key lists, like words in a dictionary (a sequence comes before the longer
+ * sequences it's a prefix of).
+ *
+ * The sequence is matched as it's typed. As soon as only one sequence is left
+ * and it has been completely typed, it's triggered without waiting for
+ * LEADER_TIMEOUT. A sequence that is a prefix of others is triggered when the
+ * timeout elapses. A LEADER_SEQ sends its keycode, a LEADER_SEQ_ACTION calls
+ * process_leader_event() with its index in the table.
+ */
+typedef struct {
+    const uint16_t *keys;
+    uint16_t keycode;
+} leader_seq_t;
+
+#define LEADER_SEQ(lk, lc)      {.keys = &(lk)[0], .keycode = (lc)}
+#define LEADER_SEQ_ACTION(lk)   {.keys = &(lk)[0]}
+
+#ifndef LEADER_SEQUENCE_COUNT
+#define LEADER_SEQUENCE_COUNT 0
+#endif
+
+extern const leader_seq_t leader_sequences[];
+void process_leader_event(uint16_t seq_index);
+/* Whether leader_sequences is sorted and has no duplicates. With
+ * CONSOLE_ENABLE it's checked on the first leader key press, keymap
+ * tests can check it too.
+ */
+bool leader_sequences_sorted(void);
+
 
 #define SEQ_ONE_KEY(key) if (leader_sequence[0] == (key) && leader_sequence[1] == 0 && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
 #define SEQ_TWO_KEYS(key1, key2) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
@@ -15,13 +15,87 @@
  */
 #include "quantum.h"
 #include "action_tapping.h"
+#include "deferred.h"
 
 #ifndef NO_ACTION_ONESHOT
 uint8_t get_oneshot_mods(void);
 #endif
 
 static uint16_t last_td;
-static int8_t highest_td = -1;
+
+/* Dances with a non-zero count, so that key presses and timeouts don't have
+ * to look at every tap dance action. td_deadline is the earliest time one of
+ * them can time out, td_token is the deferred callback for it.
+ */
+static uint8_t active_tds[(QK_TAP_DANCE_MAX - QK_TAP_DANCE + 8) / 8];
+static uint16_t active_td_count = 0;
+static uint16_t td_deadline;
+static bool td_deadline_valid = false;
+static bool td_has_deadline = false;
+static deferred_token_t td_token = DEFERRED_TOKEN_NONE;
+
+static void schedule_tap_dance (void);
+
+static inline void set_td_active (uint16_t idx, bool active) {
+  uint8_t mask = 1 << (idx & 7);
+  bool was_active = active_tds[idx / 8] & mask;
+
+  if (active && !was_active) {
+    active_tds[idx / 8] |= mask;
+    active_td_count++;
+  } else if (!active && was_active) {
+    active_tds[idx / 8] &= ~mask;
+    active_td_count--;
+  }
+  td_deadline_valid = false;
+  schedule_tap_dance();
+}
+
+// Returns the first active dance after idx, or -1
+static int16_t next_active_td (int16_t idx) {
+  if (!active_td_count)
+    return -1;
+  for (uint16_t i = idx + 1; i < sizeof(active_tds) * 8; i++) {
+    uint8_t bits = active_tds[i / 8] >> (i & 7);
+    if (!bits) {
+      i |= 7;
+      continue;
+    }
+    if (bits & 1)
+      return i;
+  }
+  return -1;
+}
+
+static inline uint16_t get_tapping_term (qk_tap_dance_action_t *action) {
+  if (action->custom_tapping_term > 0) {
+    return action->custom_tapping_term;
+  }
+  return TAPPING_TERM;
+}
+
+bool tap_dance_next_deadline (uint16_t *deadline) {
+  if (!td_deadline_valid) {
+    td_has_deadline = false;
+    for (int16_t i = next_active_td(-1); i >= 0; i = next_active_td(i)) {
+      qk_tap_dance_action_t *action = &tap_dance_actions[i];
+      // A finished dance only waits for its key to be released
+      if (action->state.finished)
+        continue;
+      // The dance times out once more than the tapping term has elapsed
+      uint16_t expiry = action->state.timer + get_tapping_term(action) + 1;
+      if (!td_has_deadline || (int16_t)(expiry - td_deadline) < 0) {
+        td_deadline = expiry;
+        td_has_deadline = true;
+      }
+    }
+    td_deadline_valid = true;
+  }
+
+  if (td_has_deadline)
+    *deadline = td_deadline;
+  return td_has_deadline;
+}
 
 void qk_tap_dance_pair_on_each_tap (qk_tap_dance_state_t *state, void *user_data) {
   qk_tap_dance_pair_t *pair = (qk_tap_dance_pair_t *)user_data;
@@ -118,10 +192,7 @@ void preprocess_tap_dance(uint16_t keycode, keyrecord_t *record) {
   if (!record->event.pressed)
     return;
 
-  if (highest_td == -1)
-    return;
-
-  for (int i = 0; i <= highest_td; i++) {
+  for (int16_t i = next_active_td(-1); i >= 0; i = next_active_td(i)) {
     action = &tap_dance_actions[i];
     if (action->state.count) {
       if (keycode == action->state.keycode && keycode == last_td)
@@ -139,8 +210,6 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
 
   switch(keycode) {
   case QK_TAP_DANCE ... QK_TAP_DANCE_MAX:
-    if ((int16_t)idx > highest_td)
-      highest_td = idx;
     action = &tap_dance_actions[idx];
 
     action->state.pressed = record->event.pressed;
@@ -148,6 +217,7 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
       action->state.keycode = keycode;
       action->state.count++;
       action->state.timer = timer_read();
+      set_td_active(idx, true);
 #ifndef NO_ACTION_ONESHOT
       action->state.oneshot_mods = get_oneshot_mods();
 #else
@@ -172,24 +242,30 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
 
 
 
-void matrix_scan_tap_dance () {
-  if (highest_td == -1)
-    return;
-  uint16_t tap_user_defined;
+static void tap_dance_timeout (void *arg) {
+  td_token = DEFERRED_TOKEN_NONE;
 
-  for (uint8_t i = 0; i <= highest_td; i++) {
+  for (int16_t i = next_active_td(-1); i >= 0; i = next_active_td(i)) {
     qk_tap_dance_action_t *action = &tap_dance_actions[i];
-    if(action->custom_tapping_term > 0 ) {
-      tap_user_defined = action->custom_tapping_term;
-    }
-    else{
-      tap_user_defined = TAPPING_TERM;
-    }
-    if (action->state.count && timer_elapsed (action->state.timer) > tap_user_defined) {
+    if (action->state.count && timer_elapsed (action->state.timer) > get_tapping_term(action)) {
       process_tap_dance_action_on_dance_finished (action);
       reset_tap_dance (&action->state);
     }
   }
+
+  td_deadline_valid = false;
+  schedule_tap_dance();
+}
+
+static void schedule_tap_dance (void) {
+  uint16_t deadline;
+
+  deferred_cancel(td_token);
+  td_token = DEFERRED_TOKEN_NONE;
+  if (tap_dance_next_deadline(&deadline)) {
+    int16_t delay = deadline - timer_read();
+    td_token = deferred_add_reserved(delay > 0 ? delay : 0, tap_dance_timeout, NULL);
+  }
 }
 
 void reset_tap_dance (qk_tap_dance_state_t *state) {
@@ -206,4 +282,5 @@ void reset_tap_dance (qk_tap_dance_state_t *state) {
   state->interrupted = false;
   state->finished = false;
   last_td = 0;
+  set_td_active(state->keycode - QK_TAP_DANCE, false);
 }
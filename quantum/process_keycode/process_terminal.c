@@ -127,8 +127,6 @@ void terminal_about(void) {
 
 void terminal_help(void);
 
-extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
-
 void terminal_keycode(void) {
     if (strlen(arguments[1]) != 0 && strlen(arguments[2]) != 0 && strlen(arguments[3]) != 0) {
         char keycode_dec[5];
@@ -136,7 +134,7 @@ void terminal_keycode(void) {
         uint16_t layer = strtol(arguments[1], (char **)NULL, 10);
         uint16_t row = strtol(arguments[2], (char **)NULL, 10);
         uint16_t col = strtol(arguments[3], (char **)NULL, 10);
-        uint16_t keycode = pgm_read_word(&keymaps[layer][row][col]);
+        uint16_t keycode = keymap_key_to_keycode(layer, (keypos_t){ .row = row, .col = col });
         itoa(keycode, keycode_dec, 10);
         itoa(keycode, keycode_hex, 16);
         SEND_STRING("0x");
@@ -156,7 +154,7 @@ void terminal_keymap(void) {
         uint16_t layer = strtol(arguments[1], (char **)NULL, 10);
         for (int r = 0; r < MATRIX_ROWS; r++) {
             for (int c = 0; c < MATRIX_COLS; c++) {
-                uint16_t keycode = pgm_read_word(&keymaps[layer][r][c]);
+                uint16_t keycode = keymap_key_to_keycode(layer, (keypos_t){ .row = r, .col = c });
                 char keycode_s[8];
                 sprintf(keycode_s, "0x%04x,", keycode);
                 send_string(keycode_s);
@@ -28,6 +28,7 @@
 #endif
 
 #include "backlight.h"
+#include "perf_stats.h"
 extern backlight_config_t backlight_config;
 
 #ifdef FAUXCLICKY_ENABLE
@@ -189,25 +190,8 @@ static bool grave_esc_was_shifted = false;
 
 bool process_record_quantum(keyrecord_t *record) {
 
-  /* This gets the keycode from the key pressed */
-  keypos_t key = record->event.key;
-  uint16_t keycode;
-
-  #if !defined(NO_ACTION_LAYER) && defined(PREVENT_STUCK_MODIFIERS)
-    /* TODO: Use store_or_get_action() or a similar function. */
-    if (!disable_action_cache) {
-      uint8_t layer;
-
-      if (record->event.pressed) {
-        layer = layer_switch_get_layer(key);
-        update_source_layers_cache(key, layer);
-      } else {
-        layer = read_source_layers_cache(key);
-      }
-      keycode = keymap_key_to_keycode(layer, key);
-    } else
-  #endif
-    keycode = keymap_key_to_keycode(layer_switch_get_layer(key), key);
+  /* The keycode has already been resolved by process_record() */
+  uint16_t keycode = record->keycode;
 
     // This is how you use actions here
     // if (keycode == KC_LEAD) {
@@ -924,35 +908,17 @@ void matrix_init_quantum() {
   matrix_init_kb();
 }
 
-uint8_t rgb_matrix_task_counter = 0;
-
-#ifndef RGB_MATRIX_SKIP_FRAMES
-  #define RGB_MATRIX_SKIP_FRAMES 1
-#endif
-
 void matrix_scan_quantum() {
   #if defined(AUDIO_ENABLE)
     matrix_scan_music();
   #endif
 
-  #ifdef TAP_DANCE_ENABLE
-    matrix_scan_tap_dance();
-  #endif
-
-  #ifdef COMBO_ENABLE
-    matrix_scan_combo();
-  #endif
-
   #if defined(BACKLIGHT_ENABLE) && defined(BACKLIGHT_PIN)
-    backlight_task();
+    PERF_MEASURE(PERF_LIGHTING, backlight_task());
   #endif
 
   #ifdef RGB_MATRIX_ENABLE
-    rgb_matrix_task();
-    if (rgb_matrix_task_counter == 0) {
-      rgb_matrix_update_pwm_buffers();
-    }
-    rgb_matrix_task_counter = ((rgb_matrix_task_counter + 1) % (RGB_MATRIX_SKIP_FRAMES + 1));
+    PERF_MEASURE(PERF_LIGHTING, rgb_matrix_task());
   #endif
 
   matrix_scan_kb();
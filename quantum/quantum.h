@@ -20,6 +20,10 @@
 #include <avr/pgmspace.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#elif defined(PROTOCOL_SIM)
+/* stand-ins for the registers that keyboard headers use */
+#include <avr/io.h>
+#include <avr/interrupt.h>
 #endif
 #include "wait.h"
 #include "matrix.h"
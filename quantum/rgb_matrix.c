@@ -17,15 +17,11 @@
 
 
 #include "rgb_matrix.h"
-#include <avr/io.h>
 #include "i2c_master.h"
-#include <util/delay.h>
-#include <avr/interrupt.h>
 #include "progmem.h"
-#include "config.h"
 #include "eeprom.h"
-#include "lufa.h"
-#include <math.h>
+#include "timer.h"
+#include <string.h>
 
 rgb_config_t rgb_matrix_config;
 
@@ -45,9 +41,29 @@ rgb_config_t rgb_matrix_config;
     #define RGB_MATRIX_MAXIMUM_BRIGHTNESS 255
 #endif
 
+// The effects used to advance once per matrix scan, which was about every
+// 5 ms while they rendered a whole frame in each scan. This keeps their speed.
+#ifndef RGB_MATRIX_TICK_MS
+    #define RGB_MATRIX_TICK_MS 5
+#endif
+
+#define RGB_MATRIX_TICKS_PER_SECOND (1000 / RGB_MATRIX_TICK_MS)
+
+#ifndef RGB_MATRIX_LED_PROCESS_LIMIT
+    #define RGB_MATRIX_LED_PROCESS_LIMIT ((DRIVER_LED_TOTAL + 4) / 5)
+#endif
+
+#ifndef MIN
+    #define MIN(a,b) (((a)<(b))?(a):(b))
+#endif
+
+#ifndef MAX
+    #define MAX(a,b) (((a)>(b))?(a):(b))
+#endif
+
 bool g_suspend_state = false;
 
-// Global tick at 20 Hz
+// Global tick, at 20 Hz by default
 uint32_t g_tick = 0;
 
 // Ticks since this key was last hit.
@@ -56,9 +72,56 @@ uint8_t g_key_hit[DRIVER_LED_TOTAL];
 // Ticks since any key was last hit.
 uint32_t g_any_key_hit = 0;
 
-#ifndef PI
-#define PI 3.14159265
-#endif
+// sin() of the first quarter turn, scaled to 255, where a full turn is 256
+static const uint8_t PROGMEM rgb_matrix_sin_table[65] = {
+      0,   6,  13,  19,  25,  31,  37,  44,  50,  56,  62,  68,  74,  80,  86,  92,
+     98, 103, 109, 115, 120, 126, 131, 136, 142, 147, 152, 157, 162, 167, 171, 176,
+    180, 185, 189, 193, 197, 201, 205, 208, 212, 215, 219, 222, 225, 228, 231, 233,
+    236, 238, 240, 242, 244, 246, 247, 249, 250, 251, 252, 253, 254, 254, 255, 255,
+    255
+};
+
+int16_t rgb_matrix_sin( uint8_t angle ) {
+    uint8_t quarter = angle & 0x3F;
+    if ( angle & 0x40 ) {
+        quarter = 64 - quarter;
+    }
+    int16_t value = pgm_read_byte( &rgb_matrix_sin_table[quarter] );
+    return ( angle & 0x80 ) ? -value : value;
+}
+
+int16_t rgb_matrix_cos( uint8_t angle ) {
+    return rgb_matrix_sin( angle + 64 );
+}
+
+// Integer square root, gives the same result as truncating sqrt()
+static uint16_t rgb_matrix_sqrt( uint32_t square ) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 16;
+    while ( bit > square ) {
+        bit >>= 2;
+    }
+    while ( bit ) {
+        if ( square >= root + bit ) {
+            square -= root + bit;
+            root = ( root >> 1 ) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+static uint32_t rgb_matrix_distance_squared( Point a, Point b ) {
+    uint8_t dx = a.x > b.x ? a.x - b.x : b.x - a.x;
+    uint8_t dy = a.y > b.y ? a.y - b.y : b.y - a.y;
+    return (uint32_t)dx * dx + (uint32_t)dy * dy;
+}
+
+uint16_t rgb_matrix_distance( Point a, Point b ) {
+    return rgb_matrix_sqrt( rgb_matrix_distance_squared( a, b ) );
+}
 
 uint32_t eeconfig_read_rgb_matrix(void) {
   return eeprom_read_dword(EECONFIG_RGB_MATRIX);
@@ -91,17 +154,39 @@ void eeconfig_debug_rgb_matrix(void) {
 uint8_t g_last_led_hit[LED_HITS_TO_REMEMBER] = {255};
 uint8_t g_last_led_count = 0;
 
+// Reverse index from the matrix to the LEDs, built by rgb_matrix_init.
+// Each key points to its first LED, and each LED to the next one on the
+// same key, in increasing order. Until then no key has any LEDs.
+#define NO_LED 255
+#if (DRIVER_LED_TOTAL) >= NO_LED
+    #error "DRIVER_LED_TOTAL must be less than 255, the LED index uses 255 for no LED"
+#endif
+static uint8_t g_key_first_led[MATRIX_ROWS][MATRIX_COLS] = {
+    [0 ... MATRIX_ROWS - 1] = { [0 ... MATRIX_COLS - 1] = NO_LED }
+};
+static uint8_t g_led_next_led[DRIVER_LED_TOTAL] = { [0 ... DRIVER_LED_TOTAL - 1] = NO_LED };
+
+static void rgb_matrix_build_led_index(void) {
+    for (uint8_t i = DRIVER_LED_TOTAL; i-- > 0;) {
+        rgb_led led = g_rgb_leds[i];
+        // LEDs that are not under a key, such as underglow
+        if (led.matrix_co.row >= MATRIX_ROWS || led.matrix_co.col >= MATRIX_COLS) {
+            continue;
+        }
+        g_led_next_led[i] = g_key_first_led[led.matrix_co.row][led.matrix_co.col];
+        g_key_first_led[led.matrix_co.row][led.matrix_co.col] = i;
+    }
+}
+
 void map_row_column_to_led( uint8_t row, uint8_t column, uint8_t *led_i, uint8_t *led_count) {
-    rgb_led led;
     *led_count = 0;
+    if (row >= MATRIX_ROWS || column >= MATRIX_COLS) {
+        return;
+    }
 
-    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-        // map_index_to_led(i, &led);
-        led = g_rgb_leds[i];
-        if (row == led.matrix_co.row && column == led.matrix_co.col) {
-            led_i[*led_count] = i;
-            (*led_count)++;
-        }
+    for (uint8_t i = g_key_first_led[row][column]; i != NO_LED; i = g_led_next_led[i]) {
+        led_i[*led_count] = i;
+        (*led_count)++;
     }
 }
 
@@ -118,6 +203,12 @@ void rgb_matrix_set_color_all( uint8_t red, uint8_t green, uint8_t blue ) {
     IS31FL3731_set_color_all( red, green, blue );
 }
 
+static void rgb_matrix_set_color_range( uint8_t led_min, uint8_t led_max, uint8_t red, uint8_t green, uint8_t blue ) {
+    for ( uint8_t i = led_min; i < led_max; i++ ) {
+        rgb_matrix_set_color( i, red, green, blue );
+    }
+}
+
 bool process_rgb_matrix(uint16_t keycode, keyrecord_t *record) {
     if ( record->event.pressed ) {
         uint8_t led[8], led_count;
@@ -149,7 +240,7 @@ void rgb_matrix_set_suspend_state(bool state) {
     g_suspend_state = state;
 }
 
-void rgb_matrix_test(void) {
+void rgb_matrix_test( uint8_t led_min, uint8_t led_max ) {
     // Mask out bits 4 and 5
     // Increase the factor to make the test animation slower (and reduce to make it faster)
     uint8_t factor = 10;
@@ -157,22 +248,22 @@ void rgb_matrix_test(void) {
     {
         case 0:
         {
-            rgb_matrix_set_color_all( 20, 0, 0 );
+            rgb_matrix_set_color_range( led_min, led_max, 20, 0, 0 );
             break;
         }
         case 1:
         {
-            rgb_matrix_set_color_all( 0, 20, 0 );
+            rgb_matrix_set_color_range( led_min, led_max, 0, 20, 0 );
             break;
         }
         case 2:
         {
-            rgb_matrix_set_color_all( 0, 0, 20 );
+            rgb_matrix_set_color_range( led_min, led_max, 0, 0, 20 );
             break;
         }
         case 3:
         {
-            rgb_matrix_set_color_all( 20, 20, 20 );
+            rgb_matrix_set_color_range( led_min, led_max, 20, 20, 20 );
             break;
         }
     }
@@ -220,20 +311,20 @@ void rgb_matrix_single_LED_test(void) {
 }
 
 // All LEDs off
-void rgb_matrix_all_off(void) {
-    rgb_matrix_set_color_all( 0, 0, 0 );
+void rgb_matrix_all_off( uint8_t led_min, uint8_t led_max ) {
+    rgb_matrix_set_color_range( led_min, led_max, 0, 0, 0 );
 }
 
 // Solid color
-void rgb_matrix_solid_color(void) {
+void rgb_matrix_solid_color( uint8_t led_min, uint8_t led_max ) {
     HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
     RGB rgb = hsv_to_rgb( hsv );
-    rgb_matrix_set_color_all( rgb.r, rgb.g, rgb.b );
+    rgb_matrix_set_color_range( led_min, led_max, rgb.r, rgb.g, rgb.b );
 }
 
-void rgb_matrix_solid_reactive(void) {
+void rgb_matrix_solid_reactive( uint8_t led_min, uint8_t led_max ) {
 	// Relies on hue being 8-bit and wrapping
-	for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+	for ( int i=led_min; i<led_max; i++ )
 	{
 		uint16_t offset2 = g_key_hit[i]<<2;
 		offset2 = (offset2<=130) ? (130-offset2) : 0;
@@ -245,13 +336,13 @@ void rgb_matrix_solid_reactive(void) {
 }
 
 // alphas = color1, mods = color2
-void rgb_matrix_alphas_mods(void) {
+void rgb_matrix_alphas_mods( uint8_t led_min, uint8_t led_max ) {
 
     RGB rgb1 = hsv_to_rgb( (HSV){ .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val } );
     RGB rgb2 = hsv_to_rgb( (HSV){ .h = (rgb_matrix_config.hue + 180) % 360, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val } );
 
     rgb_led led;
-    for (int i = 0; i < DRIVER_LED_TOTAL; i++) {
+    for (int i = led_min; i < led_max; i++) {
         led = g_rgb_leds[i];
         if ( led.matrix_co.raw < 0xFF ) {
             if ( led.modifier )
@@ -266,7 +357,7 @@ void rgb_matrix_alphas_mods(void) {
     }
 }
 
-void rgb_matrix_gradient_up_down(void) {
+void rgb_matrix_gradient_up_down( uint8_t led_min, uint8_t led_max ) {
     int16_t h1 = rgb_matrix_config.hue;
     int16_t h2 = (rgb_matrix_config.hue + 180) % 360;
     int16_t deltaH = h2 - h1;
@@ -290,7 +381,7 @@ void rgb_matrix_gradient_up_down(void) {
     HSV hsv = { .h = 0, .s = 255, .v = rgb_matrix_config.val };
     RGB rgb;
     Point point;
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
         // map_led_to_point( i, &point );
         point = g_rgb_leds[i].point;
@@ -304,7 +395,7 @@ void rgb_matrix_gradient_up_down(void) {
     }
 }
 
-void rgb_matrix_raindrops(bool initialize) {
+void rgb_matrix_raindrops( bool initialize, uint8_t led_min, uint8_t led_max ) {
     int16_t h1 = rgb_matrix_config.hue;
     int16_t h2 = (rgb_matrix_config.hue + 180) % 360;
     int16_t deltaH = h2 - h1;
@@ -327,10 +418,14 @@ void rgb_matrix_raindrops(bool initialize) {
     HSV hsv;
     RGB rgb;
 
-    // Change one LED every tick, make sure speed is not 0
-    uint8_t led_to_change = ( g_tick & ( 0x0A / (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed) ) ) == 0 ? rand() % (DRIVER_LED_TOTAL) : 255;
+    // Change one LED every tick, make sure speed is not 0.
+    // The LED is picked once per frame, when rendering its first part.
+    static uint8_t led_to_change = 255;
+    if ( led_min == 0 ) {
+        led_to_change = ( g_tick & ( 0x0A / (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed) ) ) == 0 ? rand() % (DRIVER_LED_TOTAL) : 255;
+    }
 
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
         // If initialize, all get set to random colors
         // If not, all but one will stay the same as before.
@@ -347,13 +442,13 @@ void rgb_matrix_raindrops(bool initialize) {
     }
 }
 
-void rgb_matrix_cycle_all(void) {
+void rgb_matrix_cycle_all( uint8_t led_min, uint8_t led_max ) {
     uint8_t offset = ( g_tick << rgb_matrix_config.speed ) & 0xFF;
 
     rgb_led led;
 
     // Relies on hue being 8-bit and wrapping
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
         // map_index_to_led(i, &led);
         led = g_rgb_leds[i];
@@ -368,13 +463,13 @@ void rgb_matrix_cycle_all(void) {
     }
 }
 
-void rgb_matrix_cycle_left_right(void) {
+void rgb_matrix_cycle_left_right( uint8_t led_min, uint8_t led_max ) {
     uint8_t offset = ( g_tick << rgb_matrix_config.speed ) & 0xFF;
     HSV hsv = { .h = 0, .s = 255, .v = rgb_matrix_config.val };
     RGB rgb;
     Point point;
     rgb_led led;
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
         // map_index_to_led(i, &led);
         led = g_rgb_leds[i];
@@ -392,13 +487,13 @@ void rgb_matrix_cycle_left_right(void) {
     }
 }
 
-void rgb_matrix_cycle_up_down(void) {
+void rgb_matrix_cycle_up_down( uint8_t led_min, uint8_t led_max ) {
     uint8_t offset = ( g_tick << rgb_matrix_config.speed ) & 0xFF;
     HSV hsv = { .h = 0, .s = 255, .v = rgb_matrix_config.val };
     RGB rgb;
     Point point;
     rgb_led led;
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
         // map_index_to_led(i, &led);
         led = g_rgb_leds[i];
@@ -417,65 +512,84 @@ void rgb_matrix_cycle_up_down(void) {
 }
 
 
-void rgb_matrix_dual_beacon(void) {
+void rgb_matrix_dual_beacon( uint8_t led_min, uint8_t led_max ) {
     HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
     RGB rgb;
-    rgb_led led;
-    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-        led = g_rgb_leds[i];
-        hsv.h = ((led.point.y - 32.0)* cos(g_tick * PI / 128) / 32 + (led.point.x - 112.0) * sin(g_tick * PI / 128) / (112)) * (180) + rgb_matrix_config.hue;
+    Point point;
+    // Hue per unit of distance from the center, scaled by 256
+    int32_t cos_value = rgb_matrix_cos( g_tick ) * 180 / 32;
+    int32_t sin_value = rgb_matrix_sin( g_tick ) * 180 / 112;
+    for (uint8_t i = led_min; i < led_max; i++) {
+        point = g_rgb_leds[i].point;
+        hsv.h = ( ( point.y - 32 ) * cos_value + ( point.x - 112 ) * sin_value ) / 256 + rgb_matrix_config.hue;
         rgb = hsv_to_rgb( hsv );
         rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
     }
 }
 
-void rgb_matrix_rainbow_beacon(void) {
+void rgb_matrix_rainbow_beacon( uint8_t led_min, uint8_t led_max ) {
     HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
     RGB rgb;
-    rgb_led led;
-    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-        led = g_rgb_leds[i];
-        hsv.h = (1.5 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * (led.point.y - 32.0)* cos(g_tick * PI / 128) + (1.5 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * (led.point.x - 112.0) * sin(g_tick * PI / 128) + rgb_matrix_config.hue;
+    Point point;
+    int32_t speed = 3 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed);
+    int32_t cos_value = speed * rgb_matrix_cos( g_tick ) / 2;
+    int32_t sin_value = speed * rgb_matrix_sin( g_tick ) / 2;
+    for (uint8_t i = led_min; i < led_max; i++) {
+        point = g_rgb_leds[i].point;
+        hsv.h = ( ( point.y - 32 ) * cos_value + ( point.x - 112 ) * sin_value ) / 256 + rgb_matrix_config.hue;
         rgb = hsv_to_rgb( hsv );
         rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
     }
 }
 
-void rgb_matrix_rainbow_pinwheels(void) {
+void rgb_matrix_rainbow_pinwheels( uint8_t led_min, uint8_t led_max ) {
     HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
     RGB rgb;
-    rgb_led led;
-    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-        led = g_rgb_leds[i];
-        hsv.h = (2 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * (led.point.y - 32.0)* cos(g_tick * PI / 128) + (2 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * (66 - abs(led.point.x - 112.0)) * sin(g_tick * PI / 128) + rgb_matrix_config.hue;
+    Point point;
+    int32_t speed = 2 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed);
+    int32_t cos_value = speed * rgb_matrix_cos( g_tick );
+    int32_t sin_value = speed * rgb_matrix_sin( g_tick );
+    for (uint8_t i = led_min; i < led_max; i++) {
+        point = g_rgb_leds[i].point;
+        hsv.h = ( ( point.y - 32 ) * cos_value + ( 66 - abs( point.x - 112 ) ) * sin_value ) / 256 + rgb_matrix_config.hue;
         rgb = hsv_to_rgb( hsv );
         rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
     }
 }
 
-void rgb_matrix_rainbow_moving_chevron(void) {
+void rgb_matrix_rainbow_moving_chevron( uint8_t led_min, uint8_t led_max ) {
     HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
     RGB rgb;
-    rgb_led led;
-    for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
-        led = g_rgb_leds[i];
-        // uint8_t r = g_tick;
-        uint8_t r = 32;
-        hsv.h = (1.5 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * abs(led.point.y - 32.0)* sin(r * PI / 128) + (1.5 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed)) * (led.point.x - (g_tick / 256.0 * 224)) * cos(r * PI / 128) + rgb_matrix_config.hue;
+    Point point;
+    // The chevron is fixed at an eighth of a turn, where sin and cos are equal
+    uint8_t r = 32;
+    uint32_t speed = 3 * (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed);
+    uint32_t sin_value = speed * rgb_matrix_sin( r ) / 2;
+    uint32_t cos_value = speed * rgb_matrix_cos( r ) / 2;
+    // g_tick / 256 * 224 without overflowing, the hue only depends on the low
+    // bits of the unsigned product so it keeps moving smoothly when this wraps
+    uint32_t position = g_tick - ( ( g_tick + 7 ) >> 3 );
+    for (uint8_t i = led_min; i < led_max; i++) {
+        point = g_rgb_leds[i].point;
+        hsv.h = ( abs( point.y - 32 ) * sin_value + ( point.x - position ) * cos_value ) / 256 + rgb_matrix_config.hue;
         rgb = hsv_to_rgb( hsv );
         rgb_matrix_set_color( i, rgb.r, rgb.g, rgb.b );
     }
 }
 
 
-void rgb_matrix_jellybean_raindrops( bool initialize ) {
+void rgb_matrix_jellybean_raindrops( bool initialize, uint8_t led_min, uint8_t led_max ) {
     HSV hsv;
     RGB rgb;
 
-    // Change one LED every tick, make sure speed is not 0
-    uint8_t led_to_change = ( g_tick & ( 0x0A / (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed) ) ) == 0 ? rand() % (DRIVER_LED_TOTAL) : 255;
+    // Change one LED every tick, make sure speed is not 0.
+    // The LED is picked once per frame, when rendering its first part.
+    static uint8_t led_to_change = 255;
+    if ( led_min == 0 ) {
+        led_to_change = ( g_tick & ( 0x0A / (rgb_matrix_config.speed == 0 ? 1 : rgb_matrix_config.speed) ) ) == 0 ? rand() % (DRIVER_LED_TOTAL) : 255;
+    }
 
-    for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
+    for ( int i=led_min; i<led_max; i++ )
     {
         // If initialize, all get set to random colors
         // If not, all but one will stay the same as before.
@@ -492,22 +606,36 @@ void rgb_matrix_jellybean_raindrops( bool initialize ) {
     }
 }
 
-void rgb_matrix_multisplash(void) {
+// Brightness of the splash ring from hit_led at point, 0..255. The ring
+// expands 4 units per tick, the square root is only needed for the LEDs
+// close to its edge, everything else is saturated.
+static uint8_t rgb_matrix_splash_effect( Point point, uint8_t hit_led ) {
+    uint16_t radius = g_key_hit[hit_led] << 2;
+    uint32_t square = rgb_matrix_distance_squared( point, g_rgb_leds[hit_led].point );
+    // Outside of the ring, the subtraction below would wrap around
+    if ( square >= (uint32_t)( radius + 1 ) * ( radius + 1 ) ) {
+        return 255;
+    }
+    // Far enough inside of the ring
+    if ( radius >= 255 && square < (uint32_t)( radius - 254 ) * ( radius - 254 ) ) {
+        return 255;
+    }
+    return MIN( radius - rgb_matrix_sqrt( square ), 255 );
+}
+
+void rgb_matrix_multisplash( uint8_t led_min, uint8_t led_max ) {
     // if (g_any_key_hit < 0xFF) {
         HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
         RGB rgb;
         rgb_led led;
-        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        for (uint8_t i = led_min; i < led_max; i++) {
             led = g_rgb_leds[i];
             uint16_t c = 0, d = 0;
-            rgb_led last_led;
             // if (g_last_led_count) {
                 for (uint8_t last_i = 0; last_i < g_last_led_count; last_i++) {
-                    last_led = g_rgb_leds[g_last_led_hit[last_i]];
-                    uint16_t dist = (uint16_t)sqrt(pow(led.point.x - last_led.point.x, 2) + pow(led.point.y - last_led.point.y, 2));
-                    uint16_t effect = (g_key_hit[g_last_led_hit[last_i]] << 2) - dist;
-                    c += MIN(MAX(effect, 0), 255);
-                    d += 255 - MIN(MAX(effect, 0), 255);
+                    uint8_t effect = rgb_matrix_splash_effect( led.point, g_last_led_hit[last_i] );
+                    c += effect;
+                    d += 255 - effect;
                 }
             // } else {
             //     d = 255;
@@ -523,27 +651,23 @@ void rgb_matrix_multisplash(void) {
 }
 
 
-void rgb_matrix_splash(void) {
+void rgb_matrix_splash( uint8_t led_min, uint8_t led_max ) {
     g_last_led_count = MIN(g_last_led_count, 1);
-    rgb_matrix_multisplash();
+    rgb_matrix_multisplash( led_min, led_max );
 }
 
 
-void rgb_matrix_solid_multisplash(void) {
+void rgb_matrix_solid_multisplash( uint8_t led_min, uint8_t led_max ) {
     // if (g_any_key_hit < 0xFF) {
         HSV hsv = { .h = rgb_matrix_config.hue, .s = rgb_matrix_config.sat, .v = rgb_matrix_config.val };
         RGB rgb;
         rgb_led led;
-        for (uint8_t i = 0; i < DRIVER_LED_TOTAL; i++) {
+        for (uint8_t i = led_min; i < led_max; i++) {
             led = g_rgb_leds[i];
             uint16_t d = 0;
-            rgb_led last_led;
             // if (g_last_led_count) {
                 for (uint8_t last_i = 0; last_i < g_last_led_count; last_i++) {
-                    last_led = g_rgb_leds[g_last_led_hit[last_i]];
-                    uint16_t dist = (uint16_t)sqrt(pow(led.point.x - last_led.point.x, 2) + pow(led.point.y - last_led.point.y, 2));
-                    uint16_t effect = (g_key_hit[g_last_led_hit[last_i]] << 2) - dist;
-                    d += 255 - MIN(MAX(effect, 0), 255);
+                    d += 255 - rgb_matrix_splash_effect( led.point, g_last_led_hit[last_i] );
                 }
             // } else {
             //     d = 255;
@@ -558,15 +682,15 @@ void rgb_matrix_solid_multisplash(void) {
 }
 
 
-void rgb_matrix_solid_splash(void) {
+void rgb_matrix_solid_splash( uint8_t led_min, uint8_t led_max ) {
     g_last_led_count = MIN(g_last_led_count, 1);
-    rgb_matrix_solid_multisplash();
+    rgb_matrix_solid_multisplash( led_min, led_max );
 }
 
 
 // Needs eeprom access that we don't have setup currently
 
-void rgb_matrix_custom(void) {
+void rgb_matrix_custom( uint8_t led_min, uint8_t led_max ) {
 //     HSV hsv;
 //     RGB rgb;
 //     for ( int i=0; i<DRIVER_LED_TOTAL; i++ )
@@ -579,120 +703,188 @@ void rgb_matrix_custom(void) {
 //     }
 }
 
-void rgb_matrix_task(void) {
+// The tick of the previous frame, the animations advance one tick per
+// RGB_MATRIX_TICK_MS regardless of how often frames are rendered
+static uint16_t g_tick_timer = 0;
+
+// A frame is rendered RGB_MATRIX_LED_PROCESS_LIMIT LEDs at a time and then
+// flushed one driver at a time, each step in its own call of rgb_matrix_task,
+// so that no single matrix scan is held up for a whole frame.
+enum rgb_matrix_render_state {
+    RENDER_STARTING,
+    RENDER_EFFECT,
+    RENDER_FLUSH_DRIVER_1,
+    RENDER_FLUSH_DRIVER_2,
+};
+
+static uint8_t g_render_state = RENDER_STARTING;
+static uint8_t g_render_led = 0;
+static uint8_t g_render_effect = 0;
+static bool g_render_initialize = false;
+static bool g_render_suspended = false;
+
+// Advances the animations by the time elapsed since the previous frame,
+// returns false if it is not time for a new frame yet
+static bool rgb_matrix_start_frame(void) {
     static uint8_t toggle_enable_last = 255;
+    uint16_t ticks = timer_elapsed( g_tick_timer ) / RGB_MATRIX_TICK_MS;
+    if ( ticks == 0 ) {
+        return false;
+    }
+    g_tick_timer += ticks * RGB_MATRIX_TICK_MS;
+
 	if (!rgb_matrix_config.enable) {
-    	rgb_matrix_all_off();
         toggle_enable_last = rgb_matrix_config.enable;
-    	return;
+    	return true;
     }
     // delay 1 second before driving LEDs or doing anything else
-    static uint8_t startup_tick = 0;
-    if ( startup_tick < 20 ) {
-        startup_tick++;
-        return;
+    static uint16_t startup_tick = 0;
+    if ( startup_tick < RGB_MATRIX_TICKS_PER_SECOND ) {
+        startup_tick += MIN( ticks, RGB_MATRIX_TICKS_PER_SECOND );
+        return false;
     }
 
-    g_tick++;
+    g_tick += ticks;
 
-    if ( g_any_key_hit < 0xFFFFFFFF ) {
-        g_any_key_hit++;
+    if ( g_any_key_hit < 0xFFFFFFFF - ticks ) {
+        g_any_key_hit += ticks;
+    } else {
+        g_any_key_hit = 0xFFFFFFFF;
     }
 
     for ( int led = 0; led < DRIVER_LED_TOTAL; led++ ) {
         if ( g_key_hit[led] < 255 ) {
-            if (g_key_hit[led] == 254)
+            if ( g_key_hit[led] + ticks >= 255 ) {
                 g_last_led_count = MAX(g_last_led_count - 1, 0);
-            g_key_hit[led]++;
+                g_key_hit[led] = 255;
+            } else {
+                g_key_hit[led] += ticks;
+            }
         }
     }
 
-    // Factory default magic value
-    if ( rgb_matrix_config.mode == 255 ) {
-        rgb_matrix_test();
-        return;
-    }
-
     // Ideally we would also stop sending zeros to the LED driver PWM buffers
     // while suspended and just do a software shutdown. This is a cheap hack for now.
     bool suspend_backlight = ((g_suspend_state && RGB_DISABLE_WHEN_USB_SUSPENDED) ||
-            (RGB_DISABLE_AFTER_TIMEOUT > 0 && g_any_key_hit > RGB_DISABLE_AFTER_TIMEOUT * 60 * 20));
+            (RGB_DISABLE_AFTER_TIMEOUT > 0 && g_any_key_hit > RGB_DISABLE_AFTER_TIMEOUT * 60UL * RGB_MATRIX_TICKS_PER_SECOND));
     uint8_t effect = suspend_backlight ? 0 : rgb_matrix_config.mode;
 
     // Keep track of the effect used last time,
     // detect change in effect, so each effect can
     // have an optional initialization.
     static uint8_t effect_last = 255;
-    bool initialize = (effect != effect_last) || (rgb_matrix_config.enable != toggle_enable_last);
+    g_render_initialize = (effect != effect_last) || (rgb_matrix_config.enable != toggle_enable_last);
     effect_last = effect;
     toggle_enable_last = rgb_matrix_config.enable;
+    g_render_effect = effect;
+    g_render_suspended = suspend_backlight;
+    return true;
+}
+
+static void rgb_matrix_render( uint8_t led_min, uint8_t led_max ) {
+    if (!rgb_matrix_config.enable) {
+        rgb_matrix_all_off( led_min, led_max );
+        return;
+    }
+
+    // Factory default magic value
+    if ( rgb_matrix_config.mode == 255 ) {
+        rgb_matrix_test( led_min, led_max );
+        return;
+    }
 
-    // this gets ticked at 20 Hz.
-    // each effect can opt to do calculations
-    // and/or request PWM buffer updates.
-    switch ( effect ) {
+    switch ( g_render_effect ) {
         case RGB_MATRIX_SOLID_COLOR:
-            rgb_matrix_solid_color();
+            rgb_matrix_solid_color( led_min, led_max );
             break;
         case RGB_MATRIX_ALPHAS_MODS:
-            rgb_matrix_alphas_mods();
+            rgb_matrix_alphas_mods( led_min, led_max );
             break;
         case RGB_MATRIX_DUAL_BEACON:
-            rgb_matrix_dual_beacon();
+            rgb_matrix_dual_beacon( led_min, led_max );
             break;
         case RGB_MATRIX_GRADIENT_UP_DOWN:
-            rgb_matrix_gradient_up_down();
+            rgb_matrix_gradient_up_down( led_min, led_max );
             break;
         case RGB_MATRIX_RAINDROPS:
-            rgb_matrix_raindrops( initialize );
+            rgb_matrix_raindrops( g_render_initialize, led_min, led_max );
             break;
         case RGB_MATRIX_CYCLE_ALL:
-            rgb_matrix_cycle_all();
+            rgb_matrix_cycle_all( led_min, led_max );
             break;
         case RGB_MATRIX_CYCLE_LEFT_RIGHT:
-            rgb_matrix_cycle_left_right();
+            rgb_matrix_cycle_left_right( led_min, led_max );
             break;
         case RGB_MATRIX_CYCLE_UP_DOWN:
-            rgb_matrix_cycle_up_down();
+            rgb_matrix_cycle_up_down( led_min, led_max );
             break;
         case RGB_MATRIX_RAINBOW_BEACON:
-            rgb_matrix_rainbow_beacon();
+            rgb_matrix_rainbow_beacon( led_min, led_max );
             break;
         case RGB_MATRIX_RAINBOW_PINWHEELS:
-            rgb_matrix_rainbow_pinwheels();
+            rgb_matrix_rainbow_pinwheels( led_min, led_max );
             break;
         case RGB_MATRIX_RAINBOW_MOVING_CHEVRON:
-            rgb_matrix_rainbow_moving_chevron();
+            rgb_matrix_rainbow_moving_chevron( led_min, led_max );
             break;
         case RGB_MATRIX_JELLYBEAN_RAINDROPS:
-            rgb_matrix_jellybean_raindrops( initialize );
+            rgb_matrix_jellybean_raindrops( g_render_initialize, led_min, led_max );
             break;
         #ifdef RGB_MATRIX_KEYPRESSES
             case RGB_MATRIX_SOLID_REACTIVE:
-                rgb_matrix_solid_reactive();
+                rgb_matrix_solid_reactive( led_min, led_max );
                 break;
             case RGB_MATRIX_SPLASH:
-                rgb_matrix_splash();
+                rgb_matrix_splash( led_min, led_max );
                 break;
             case RGB_MATRIX_MULTISPLASH:
-                rgb_matrix_multisplash();
+                rgb_matrix_multisplash( led_min, led_max );
                 break;
             case RGB_MATRIX_SOLID_SPLASH:
-                rgb_matrix_solid_splash();
+                rgb_matrix_solid_splash( led_min, led_max );
                 break;
             case RGB_MATRIX_SOLID_MULTISPLASH:
-                rgb_matrix_solid_multisplash();
+                rgb_matrix_solid_multisplash( led_min, led_max );
                 break;
         #endif
         default:
-            rgb_matrix_custom();
+            rgb_matrix_custom( led_min, led_max );
             break;
     }
+}
 
-    if ( ! suspend_backlight ) {
-        rgb_matrix_indicators();
+void rgb_matrix_task(void) {
+    switch ( g_render_state ) {
+        case RENDER_STARTING:
+            if ( !rgb_matrix_start_frame() ) {
+                break;
+            }
+            g_render_led = 0;
+            g_render_state = RENDER_EFFECT;
+            // fall through
+        case RENDER_EFFECT: {
+            uint8_t led_min = g_render_led;
+            uint8_t led_max = MIN( led_min + RGB_MATRIX_LED_PROCESS_LIMIT, DRIVER_LED_TOTAL );
+            rgb_matrix_render( led_min, led_max );
+            g_render_led = led_max;
+            if ( led_max == DRIVER_LED_TOTAL ) {
+                if ( rgb_matrix_config.enable && rgb_matrix_config.mode != 255 && !g_render_suspended ) {
+                    rgb_matrix_indicators();
+                }
+                g_render_state = RENDER_FLUSH_DRIVER_1;
+            }
+            break;
+        }
+        case RENDER_FLUSH_DRIVER_1:
+            IS31FL3731_update_pwm_buffer( DRIVER_ADDR_1, 0 );
+            g_render_state = RENDER_FLUSH_DRIVER_2;
+            break;
+        case RENDER_FLUSH_DRIVER_2:
+            IS31FL3731_update_pwm_buffer( DRIVER_ADDR_2, 1 );
+            IS31FL3731_update_led_control_registers( DRIVER_ADDR_1, DRIVER_ADDR_2 );
+            g_render_state = RENDER_STARTING;
+            break;
     }
-
 }
 
 void rgb_matrix_indicators(void) {
@@ -726,6 +918,8 @@ void rgb_matrix_indicators_user(void) {}
 
 void rgb_matrix_init(void) {
   rgb_matrix_setup_drivers();
+  rgb_matrix_build_led_index();
+  g_tick_timer = timer_read();
 
   // TODO: put the 1 second startup delay here?
 
@@ -87,6 +87,9 @@ enum rgb_matrix_effects {
 
 void rgb_matrix_set_color( int index, uint8_t red, uint8_t green, uint8_t blue );
 
+// Finds the LEDs under a key, led_i needs room for all of them
+void map_row_column_to_led( uint8_t row, uint8_t column, uint8_t *led_i, uint8_t *led_count );
+
 // This runs after another backlight effect and replaces
 // colors already set
 void rgb_matrix_indicators(void);
@@ -119,6 +122,12 @@ void rgb_matrix_decrease(void);
 // void backlight_get_key_color( uint8_t led, HSV *hsv );
 // void backlight_set_key_color( uint8_t row, uint8_t column, HSV hsv );
 
+// Fixed point helpers for the effects, a full turn is 256 and
+// sin/cos are scaled to -255..255
+int16_t rgb_matrix_sin( uint8_t angle );
+int16_t rgb_matrix_cos( uint8_t angle );
+uint16_t rgb_matrix_distance( Point a, Point b );
+
 void rgb_matrix_test_led( uint8_t index, bool red, bool green, bool blue );
 uint32_t rgb_matrix_get_tick(void);
 
@@ -26,6 +26,7 @@ SOFTWARE.
 #include "serial_link/protocol/frame_validator.h"
 #include "serial_link/protocol/physical.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 // This implements the "Consistent overhead byte stuffing protocol"
 // https://en.wikipedia.org/wiki/Consistent_Overhead_Byte_Stuffing
@@ -93,6 +94,7 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
             else {
                 // Special case for zeroes
                 state->next_zero = data;
+                state->long_frame = data == 0xFF;
                 state->data[state->data_pos++] = 0;
             }
         }
@@ -102,41 +104,67 @@ void byte_stuffer_recv_byte(uint8_t link, uint8_t data) {
     }
 }
 
-static void send_block(uint8_t link, uint8_t* start, uint8_t* end, uint8_t num_non_zero) {
-    send_data(link, &num_non_zero, 1);
-    if (end > start) {
-        send_data(link, start, end-start);
+// Puts back the zeros of a part of a frame that has been sent, code is the
+// code byte that was sent before it.
+static void restore_zeros(uint8_t* data, uint8_t* end, uint8_t code) {
+    while (code != 0xFF) {
+        data += code - 1;
+        if (data >= end) {
+            break;
+        }
+        code = *data;
+        *data++ = 0;
     }
 }
 
+// The frame is stuffed in place, every zero is replaced by the code of the
+// block that follows it, and handed to the physical layer straight from the
+// caller's buffer. Only the code of the first block, and of the blocks after
+// a full 254 byte one, don't have a zero to replace, so they are sent on
+// their own. The zeros are put back once their part has been sent.
 void byte_stuffer_send_frame(uint8_t link, uint8_t* data, uint16_t size) {
-    const uint8_t zero = 0;
     if (size > 0) {
-        uint16_t num_non_zero = 1;
+        const uint8_t zero = 0;
         uint8_t* end = data + size;
-        uint8_t* start = data;
-        while (data < end) {
-            if (num_non_zero == 0xFF) {
-                // There's more data after big non-zero block
-                // So send it, and start a new block
-                send_block(link, start, data, num_non_zero);
-                start = data;
-                num_non_zero = 1;
+        uint8_t* block = data;
+        uint8_t* sent = data;
+        // The zero that holds the code of the current block
+        uint8_t* code_pos = NULL;
+        uint8_t sent_code = 0;
+        while (true) {
+            uint8_t* block_end = block;
+            while (block_end < end && *block_end != 0 && block_end - block < 0xFE) {
+                block_end++;
+            }
+            uint8_t code = block_end - block + 1;
+            if (code_pos) {
+                *code_pos = code;
             }
             else {
-                if (*data == 0) {
-                    // A zero encountered, so send the block
-                    send_block(link, start, data, num_non_zero);
-                    start = data + 1;
-                    num_non_zero = 1;
-                }
-                else {
-                    num_non_zero++;
+                if (block > sent) {
+                    send_data(link, sent, block - sent);
+                    restore_zeros(sent, block, sent_code);
                 }
-                ++data;
+                send_data(link, &code, 1);
+                sent = block;
+                sent_code = code;
+            }
+            if (block_end == end) {
+                break;
+            }
+            if (code == 0xFF) {
+                // There's more data after big non-zero block
+                // So start a new block without using up a zero
+                code_pos = NULL;
+                block = block_end;
+            }
+            else {
+                code_pos = block_end;
+                block = block_end + 1;
             }
         }
-        send_block(link, start, data, num_non_zero);
+        send_data(link, sent, end - sent);
+        restore_zeros(sent, end, sent_code);
         send_data(link, &zero, 1);
     }
 }
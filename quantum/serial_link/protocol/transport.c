@@ -73,11 +73,10 @@ void add_remote_objects(remote_object_t** _remote_objects, uint32_t _num_remote_
     }
 }
 
-void transport_recv_frame(uint8_t from, uint8_t* data, uint16_t size) {
-    uint8_t id = data[size-1];
+static void recv_object(uint8_t from, uint8_t id, uint8_t* data, uint16_t size) {
     if (id < num_remote_objects) {
         remote_object_t* obj = remote_objects[id];
-        if (obj->object_size == size - 1) {
+        if (obj->object_size == size) {
             uint8_t* start;
             if (obj->object_type == MASTER_TO_ALL_SLAVES) {
                 start = obj->buffer + LOCAL_OBJECT_SIZE(obj->object_size);
@@ -91,38 +90,74 @@ void transport_recv_frame(uint8_t from, uint8_t* data, uint16_t size) {
             }
             triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
             void* ptr = triple_buffer_begin_write_internal(obj->object_size, tb);
-            memcpy(ptr, data, size - 1);
+            memcpy(ptr, data, size);
             triple_buffer_end_write_internal(tb);
         }
     }
 }
 
-void update_transport(void) {
+void transport_recv_frame(uint8_t from, uint8_t* data, uint16_t size) {
+    uint16_t pos = 0;
+    while (pos + TRANSPORT_OBJECT_HEADER_SIZE <= size) {
+        uint8_t id = data[pos];
+        uint8_t object_size = data[pos + 1];
+        pos += TRANSPORT_OBJECT_HEADER_SIZE;
+        if (pos + object_size > size) {
+            // The rest of the frame is truncated
+            break;
+        }
+        recv_object(from, id, data + pos, object_size);
+        pos += object_size;
+    }
+}
+
+// The router and the validator add their own bytes at the end
+static uint8_t frame[TRANSPORT_MAX_FRAME_SIZE + 1 + 4];
+static uint16_t frame_size = 0;
+
+static void send_frame(uint8_t destination) {
+    if (frame_size > 0) {
+        router_send_frame(destination, frame, frame_size);
+        frame_size = 0;
+    }
+}
+
+static void add_to_frame(uint8_t destination, uint8_t id, uint8_t* data, uint16_t size) {
+    if (frame_size + TRANSPORT_OBJECT_HEADER_SIZE + size > TRANSPORT_MAX_FRAME_SIZE) {
+        send_frame(destination);
+    }
+    frame[frame_size++] = id;
+    frame[frame_size++] = size;
+    memcpy(frame + frame_size, data, size);
+    frame_size += size;
+}
+
+// Adds the objects of the given type that were written since the last update
+static void add_written_objects(remote_object_type type, uint8_t destination) {
     unsigned int i;
     for(i=0;i<num_remote_objects;i++) {
         remote_object_t* obj = remote_objects[i];
-        if (obj->object_type == MASTER_TO_ALL_SLAVES || obj->object_type == SLAVE_TO_MASTER) {
-            triple_buffer_object_t* tb = (triple_buffer_object_t*)obj->buffer;
-            uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(obj->object_size + LOCAL_OBJECT_EXTRA, tb);
-            if (ptr) {
-                ptr[obj->object_size] = i;
-                uint8_t dest = obj->object_type == MASTER_TO_ALL_SLAVES ? 0xFF : 0;
-                router_send_frame(dest, ptr, obj->object_size + 1);
-            }
+        if (obj->object_type != type) {
+            continue;
         }
-        else {
-            uint8_t* start = obj->buffer;
-            unsigned int j;
-            for (j=0;j<NUM_SLAVES;j++) {
-                triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
-                uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(obj->object_size + LOCAL_OBJECT_EXTRA, tb);
-                if (ptr) {
-                    ptr[obj->object_size] = i;
-                    uint8_t dest = j + 1;
-                    router_send_frame(dest, ptr, obj->object_size + 1);
-                }
-                start += LOCAL_OBJECT_SIZE(obj->object_size);
-            }
+        uint8_t* start = obj->buffer;
+        if (type == MASTER_TO_SINGLE_SLAVE) {
+            start += (destination - 1) * LOCAL_OBJECT_SIZE(obj->object_size);
         }
+        triple_buffer_object_t* tb = (triple_buffer_object_t*)start;
+        uint8_t* ptr = (uint8_t*)triple_buffer_read_internal(obj->object_size + LOCAL_OBJECT_EXTRA, tb);
+        if (ptr) {
+            add_to_frame(destination, i, ptr, obj->object_size);
+        }
+    }
+    send_frame(destination);
+}
+
+void update_transport(void) {
+    add_written_objects(MASTER_TO_ALL_SLAVES, 0xFF);
+    add_written_objects(SLAVE_TO_MASTER, 0);
+    unsigned int j;
+    for (j=0;j<NUM_SLAVES;j++) {
+        add_written_objects(MASTER_TO_SINGLE_SLAVE, j + 1);
     }
 }
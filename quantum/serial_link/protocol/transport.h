@@ -31,6 +31,13 @@ SOFTWARE.
 #define NUM_SLAVES 8
 #define LOCAL_OBJECT_EXTRA 16
 
+// The objects written during one update are sent together, in frames of at
+// most this size. Every object in a frame starts with its id and length.
+#ifndef TRANSPORT_MAX_FRAME_SIZE
+#define TRANSPORT_MAX_FRAME_SIZE 256
+#endif
+#define TRANSPORT_OBJECT_HEADER_SIZE 2
+
 // master -> slave = 1 local(target all), 1 remote object
 // slave -> master = 1 local(target 0), multiple remote objects
 // master -> single slave (multiple local, target id), 1 remote object
@@ -40,10 +47,12 @@ typedef enum {
     SLAVE_TO_MASTER,
 } remote_object_type;
 
+// The buffers follow the object in the struct defined by the macros below,
+// buffer points to them
 typedef struct {
     remote_object_type object_type;
     uint16_t object_size;
-    uint8_t buffer[] __attribute__((aligned(4)));
+    uint8_t* buffer;
 } remote_object_t;
 
 #define REMOTE_OBJECT_SIZE(objectsize) \
@@ -56,8 +65,11 @@ typedef struct { \
     remote_object_t object; \
     uint8_t buffer[ \
         num_remote * REMOTE_OBJECT_SIZE(sizeof(type)) + \
-        num_local * LOCAL_OBJECT_SIZE(sizeof(type))]; \
-} remote_object_##name##_t;
+        num_local * LOCAL_OBJECT_SIZE(sizeof(type))] __attribute__((aligned(4))); \
+} remote_object_##name##_t; \
+typedef char remote_object_##name##_fits_in_a_frame[ \
+    sizeof(type) <= 255 && \
+    sizeof(type) + TRANSPORT_OBJECT_HEADER_SIZE <= TRANSPORT_MAX_FRAME_SIZE ? 1 : -1];
 
 #define MASTER_TO_ALL_SLAVES_OBJECT(name, type) \
     REMOTE_OBJECT_HELPER(name, type, 1, 1) \
@@ -65,6 +77,7 @@ typedef struct { \
         .object = { \
             .object_type = MASTER_TO_ALL_SLAVES, \
             .object_size = sizeof(type), \
+            .buffer = remote_object_##name.buffer, \
         } \
     }; \
     type* begin_write_##name(void) { \
@@ -91,6 +104,7 @@ typedef struct { \
         .object = { \
             .object_type = MASTER_TO_SINGLE_SLAVE, \
             .object_size = sizeof(type), \
+            .buffer = remote_object_##name.buffer, \
         } \
     }; \
     type* begin_write_##name(uint8_t slave) { \
@@ -121,6 +135,7 @@ typedef struct { \
         .object = { \
             .object_type = SLAVE_TO_MASTER, \
             .object_size = sizeof(type), \
+            .buffer = remote_object_##name.buffer, \
         } \
     }; \
     type* begin_write_##name(void) { \
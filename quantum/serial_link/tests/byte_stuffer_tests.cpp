@@ -26,6 +26,8 @@ SOFTWARE.
 #include "gmock/gmock.h"
 #include <vector>
 #include <algorithm>
+#include <chrono>
+#include <stdio.h>
 extern "C" {
 #include "serial_link/protocol/byte_stuffer.h"
 #include "serial_link/protocol/frame_validator.h"
@@ -51,8 +53,10 @@ public:
 
     void send_data(uint8_t link, const uint8_t* data, uint16_t size) {
         std::copy(data, data + size, std::back_inserter(sent_data));
+        num_sends++;
     }
     std::vector<uint8_t> sent_data;
+    int num_sends = 0;
 
     static ByteStuffer* Instance;
 };
@@ -481,3 +485,56 @@ TEST_F(ByteStuffer, sends_and_receives_full_roundtrip_254_bytes_and_then_zero) {
        byte_stuffer_recv_byte(1, d);
     }
 }
+
+TEST_F(ByteStuffer, sends_a_small_frame_without_copying_it) {
+    uint8_t original_data[] = { 1, 0, 3, 0, 0, 9};
+    byte_stuffer_send_frame(0, original_data, sizeof(original_data));
+    EXPECT_EQ(num_sends, 3);
+    uint8_t expected[] = {2, 1, 2, 3, 1, 2, 9, 0};
+    EXPECT_THAT(sent_data, ElementsAreArray(expected));
+}
+
+TEST_F(ByteStuffer, leaves_the_frame_unchanged_after_sending_it) {
+    uint8_t original_data[600];
+    for (size_t i = 0; i < sizeof(original_data); i++) {
+        original_data[i] = i % 300 == 0 ? 0 : i & 0xFF;
+    }
+    uint8_t data[sizeof(original_data)];
+    std::copy(original_data, original_data + sizeof(original_data), data);
+    byte_stuffer_send_frame(0, data, sizeof(data));
+    EXPECT_THAT(data, ElementsAreArray(original_data));
+}
+
+TEST_F(ByteStuffer, sends_and_receives_full_roundtrip_1000_bytes) {
+    uint8_t original_data[1000];
+    int i;
+    for(i=0;i<1000;i++) {
+        // Long non-zero runs mixed with zeroes
+        original_data[i] = i % 300 == 0 ? 0 : i * 7 + 1;
+    }
+    byte_stuffer_send_frame(0, original_data, sizeof(original_data));
+    EXPECT_GT(num_sends, 1);
+    EXPECT_CALL(*this, validator_recv_frame(_, _, _))
+        .With(Args<1, 2>(ElementsAreArray(original_data)));
+    for(auto& d : sent_data) {
+       byte_stuffer_recv_byte(1, d);
+    }
+}
+
+TEST_F(ByteStuffer, benchmark_send_throughput) {
+    uint8_t original_data[64];
+    int i;
+    for(i=0;i<64;i++) {
+        original_data[i] = i % 5 == 0 ? 0 : i;
+    }
+    const int iterations = 20000;
+    auto start = std::chrono::steady_clock::now();
+    for(i=0;i<iterations;i++) {
+        sent_data.clear();
+        byte_stuffer_send_frame(0, original_data, sizeof(original_data));
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+    printf("[ BENCHMARK] byte stuffer: %.1f MB/s, %.1f sends per 64 byte frame\n",
+        iterations * sizeof(original_data) / seconds / 1e6, (double)num_sends / iterations);
+}
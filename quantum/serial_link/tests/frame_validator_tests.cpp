@@ -24,6 +24,9 @@ SOFTWARE.
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
 extern "C" {
 #include "serial_link/protocol/frame_validator.h"
 }
@@ -32,6 +35,25 @@ using testing::_;
 using testing::ElementsAreArray;
 using testing::Args;
 
+namespace {
+    // The byte at a time CRC32 that the validator used before
+    uint32_t reference_crc32(const uint8_t* p, uint32_t size) {
+        static uint32_t table[256];
+        if (!table[1]) {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int j = 0; j < 8; j++) {
+                    c = c & 1 ? (c >> 1) ^ 0xEDB88320 : c >> 1;
+                }
+                table[i] = c;
+            }
+        }
+        uint32_t crc = 0xffffffff;
+        while (size--) crc = table[(uint8_t)crc ^ *p++] ^ (crc >> 8);
+        return crc ^ 0xffffffff;
+    }
+}
+
 class FrameValidator : public testing::Test {
 public:
     FrameValidator() {
@@ -113,3 +135,51 @@ TEST_F(FrameValidator, sends_five_bytes_with_correct_crc) {
         .With(Args<1, 2>(ElementsAreArray(expected)));
     validator_send_frame(0, original, 5);
 }
+
+TEST_F(FrameValidator, validates_frames_of_every_length_and_alignment) {
+    uint8_t data[128];
+    for (int i = 0; i < 128; i++) {
+        data[i] = i * 31 + 7;
+    }
+    for (int offset = 0; offset < 4; offset++) {
+        for (int size = 1; size < 100; size++) {
+            uint8_t* frame = data + offset;
+            uint32_t crc = reference_crc32(frame, size);
+            uint8_t copy[128];
+            memcpy(copy, frame, size);
+            memcpy(copy + size, &crc, 4);
+            EXPECT_CALL(*this, route_incoming_frame(_, _, size));
+            validator_recv_frame(0, copy, size + 4);
+        }
+    }
+}
+
+TEST_F(FrameValidator, benchmark_crc_throughput) {
+    const int size = 1024;
+    const int iterations = 2000;
+    uint8_t data[size + 4];
+    for (int i = 0; i < size; i++) {
+        data[i] = i * 13 + 5;
+    }
+    // A wrong CRC, so that the time isn't spent in the mock
+    uint32_t crc = reference_crc32(data, size) ^ 1;
+    memcpy(data + size, &crc, 4);
+    EXPECT_CALL(*this, route_incoming_frame(_, _, _))
+        .Times(0);
+
+    auto start = std::chrono::steady_clock::now();
+    volatile uint32_t sink = 0;
+    for (int i = 0; i < iterations; i++) {
+        sink = sink + reference_crc32(data, size);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        validator_recv_frame(0, data, size + 4);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double bytes = (double)size * iterations;
+    double before = bytes / std::chrono::duration<double>(middle - start).count();
+    double after = bytes / std::chrono::duration<double>(end - middle).count();
+    printf("[ BENCHMARK] crc32: %.1f MB/s byte at a time, %.1f MB/s validator\n",
+        before / 1e6, after / 1e6);
+}
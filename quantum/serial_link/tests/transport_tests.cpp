@@ -24,10 +24,12 @@ SOFTWARE.
 
 #include "gtest/gtest.h"
 #include "gmock/gmock.h"
+#include <stdio.h>
 
 using testing::_;
 using testing::ElementsAreArray;
 using testing::Args;
+using testing::AnyNumber;
 
 extern "C" {
 #include "serial_link/protocol/transport.h"
@@ -45,11 +47,15 @@ struct test_object2 {
 MASTER_TO_ALL_SLAVES_OBJECT(master_to_slave, test_object1);
 MASTER_TO_SINGLE_SLAVE_OBJECT(master_to_single_slave, test_object1);
 SLAVE_TO_MASTER_OBJECT(slave_to_master, test_object1);
+MASTER_TO_ALL_SLAVES_OBJECT(master_to_slave2, test_object2);
+MASTER_TO_ALL_SLAVES_OBJECT(master_to_slave3, test_object2);
 
 static remote_object_t* test_remote_objects[] = {
     REMOTE_OBJECT(master_to_slave),
     REMOTE_OBJECT(master_to_single_slave),
     REMOTE_OBJECT(slave_to_master),
+    REMOTE_OBJECT(master_to_slave2),
+    REMOTE_OBJECT(master_to_slave3),
 };
 
 class Transport : public testing::Test {
@@ -152,7 +158,7 @@ TEST_F(Transport, ignores_object_with_invalid_id) {
     end_write_master_to_single_slave(3);
     EXPECT_CALL(*this, router_send_frame(4));
     update_transport();
-    sent_data[sent_data.size() - 1] = 44;
+    sent_data[0] = 44;
     transport_recv_frame(0, sent_data.data(), sent_data.size());
     test_object1* obj2 = read_master_to_single_slave();
     EXPECT_EQ(obj2, nullptr);
@@ -166,7 +172,7 @@ TEST_F(Transport, ignores_object_with_size_too_small) {
     end_write_master_to_slave();
     EXPECT_CALL(*this, router_send_frame(_));
     update_transport();
-    sent_data[sent_data.size() - 2] = 0;
+    sent_data[1] = sizeof(test_object1) - 1;
     transport_recv_frame(0, sent_data.data(), sent_data.size() - 1);
     test_object1* obj2 = read_master_to_slave();
     EXPECT_EQ(obj2, nullptr);
@@ -181,8 +187,87 @@ TEST_F(Transport, ignores_object_with_size_too_big) {
     EXPECT_CALL(*this, router_send_frame(_));
     update_transport();
     sent_data.resize(sent_data.size() + 22);
-    sent_data[sent_data.size() - 1] = 0;
+    sent_data[1] = sizeof(test_object1) + 22;
     transport_recv_frame(0, sent_data.data(), sent_data.size());
     test_object1* obj2 = read_master_to_slave();
     EXPECT_EQ(obj2, nullptr);
 }
+
+TEST_F(Transport, sends_objects_written_together_in_one_frame) {
+    update_transport();
+    EXPECT_CALL(*this, signal_data_written()).Times(3);
+    begin_write_master_to_slave()->test = 1;
+    end_write_master_to_slave();
+    test_object2* obj = begin_write_master_to_slave2();
+    obj->test1 = 2;
+    obj->test2 = 3;
+    end_write_master_to_slave2();
+    begin_write_master_to_slave3()->test1 = 4;
+    end_write_master_to_slave3();
+    EXPECT_CALL(*this, router_send_frame(0xFF));
+    update_transport();
+    EXPECT_EQ(sent_data.size(), 3 * TRANSPORT_OBJECT_HEADER_SIZE + sizeof(test_object1) + 2 * sizeof(test_object2));
+    transport_recv_frame(0, sent_data.data(), sent_data.size());
+    EXPECT_EQ(read_master_to_slave()->test, 1);
+    test_object2* obj2 = read_master_to_slave2();
+    EXPECT_NE(obj2, nullptr);
+    EXPECT_EQ(obj2->test1, 2);
+    EXPECT_EQ(obj2->test2, 3);
+    EXPECT_EQ(read_master_to_slave3()->test1, 4);
+}
+
+TEST_F(Transport, sends_separate_frames_to_separate_destinations) {
+    update_transport();
+    EXPECT_CALL(*this, signal_data_written()).Times(3);
+    begin_write_master_to_slave()->test = 1;
+    end_write_master_to_slave();
+    begin_write_master_to_single_slave(1)->test = 2;
+    end_write_master_to_single_slave(1);
+    begin_write_master_to_single_slave(5)->test = 3;
+    end_write_master_to_single_slave(5);
+    EXPECT_CALL(*this, router_send_frame(0xFF));
+    EXPECT_CALL(*this, router_send_frame(2));
+    EXPECT_CALL(*this, router_send_frame(6));
+    update_transport();
+}
+
+TEST_F(Transport, keeps_the_objects_before_a_truncated_one) {
+    update_transport();
+    EXPECT_CALL(*this, signal_data_written()).Times(2);
+    begin_write_master_to_slave()->test = 8;
+    end_write_master_to_slave();
+    begin_write_master_to_slave2()->test1 = 9;
+    end_write_master_to_slave2();
+    EXPECT_CALL(*this, router_send_frame(0xFF));
+    update_transport();
+    transport_recv_frame(0, sent_data.data(), sent_data.size() - 1);
+    EXPECT_EQ(read_master_to_slave()->test, 8);
+    EXPECT_EQ(read_master_to_slave2(), nullptr);
+}
+
+// Counts the bytes on the wire for the objects that are written in one
+// update, with the router's destination, the CRC and the byte stuffing
+// added to every frame
+TEST_F(Transport, benchmark_protocol_efficiency) {
+    const int frame_overhead = 1 + 4 + 2;
+    const int num_objects = 3;
+    const int payload = sizeof(test_object1) + 2 * sizeof(test_object2);
+    // One frame per object, with the id after the data
+    const int separate = payload + num_objects * (1 + frame_overhead);
+
+    update_transport();
+    EXPECT_CALL(*this, signal_data_written()).Times(AnyNumber());
+    EXPECT_CALL(*this, router_send_frame(_)).Times(1);
+    begin_write_master_to_slave();
+    end_write_master_to_slave();
+    begin_write_master_to_slave2();
+    end_write_master_to_slave2();
+    begin_write_master_to_slave3();
+    end_write_master_to_slave3();
+    update_transport();
+    const int batched = sent_data.size() + frame_overhead;
+
+    printf("[ BENCHMARK] %d objects, %d bytes of data: %d bytes in separate frames, %d bytes batched\n",
+        num_objects, payload, separate, batched);
+    EXPECT_LT(batched, separate);
+}
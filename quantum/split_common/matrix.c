@@ -31,6 +31,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "config.h"
 #include "timer.h"
 #include "split_flags.h"
+#include "debounce.h"
 
 #ifdef RGBLIGHT_ENABLE
 #   include "rgblight.h"
@@ -46,15 +47,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #  include "serial.h"
 #endif
 
-#ifndef DEBOUNCING_DELAY
-#   define DEBOUNCING_DELAY 5
-#endif
-
-#if (DEBOUNCING_DELAY > 0)
-    static uint16_t debouncing_time;
-    static bool debouncing = false;
-#endif
-
 #if (MATRIX_COLS <= 8)
 #    define print_matrix_header()  print("\nr/c 01234567\n")
 #    define print_matrix_row(row)  print_bin_reverse8(matrix_get_row(row))
@@ -63,7 +55,6 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #else
 #    error "Currently only supports 8 COLS"
 #endif
-static matrix_row_t matrix_debouncing[MATRIX_ROWS];
 
 #define ERROR_DISCONNECT_COUNT 5
 
@@ -74,9 +65,28 @@ static uint8_t error_count = 0;
 static const uint8_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
 static const uint8_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
 
+// How long to wait after selecting a row (or col) before reading, in microseconds
+#ifndef MATRIX_IO_DELAY
+#    define MATRIX_IO_DELAY 30
+#endif
+
+#if (DIODE_DIRECTION == COL2ROW)
+/* The col pins grouped by their port, so that a row is read with one access
+ * per port. Filled by init_cols(). A pin keeps its port in the upper 4 bits,
+ * so the cols can't be on more than 16 ports, and the tables can't overflow
+ * whatever MATRIX_COL_PINS holds.
+ */
+#define COL_PORTS_MAX (MATRIX_COLS < 16 ? MATRIX_COLS : 16)
+static uint8_t col_port_count;
+static uint8_t col_port_addr[COL_PORTS_MAX];  // the PINx register
+static uint8_t col_port_mask[COL_PORTS_MAX];  // the bits of all its cols
+static uint8_t col_port[MATRIX_COLS];
+static uint8_t col_mask[MATRIX_COLS];
+#endif
+
 /* matrix state(1:on, 0:off) */
-static matrix_row_t matrix[MATRIX_ROWS];
-static matrix_row_t matrix_debouncing[MATRIX_ROWS];
+static matrix_row_t raw_matrix[MATRIX_ROWS];  // raw values
+static matrix_row_t matrix[MATRIX_ROWS];      // debounced values
 
 #if (DIODE_DIRECTION == COL2ROW)
     static void init_cols(void);
@@ -148,10 +158,12 @@ void matrix_init(void)
 
     // initialize matrix state: all keys off
     for (uint8_t i=0; i < MATRIX_ROWS; i++) {
+        raw_matrix[i] = 0;
         matrix[i] = 0;
-        matrix_debouncing[i] = 0;
     }
-    
+
+    debounce_init(ROWS_PER_HAND);
+
     matrix_init_quantum();
     
 }
@@ -159,47 +171,20 @@ void matrix_init(void)
 uint8_t _matrix_scan(void)
 {
     int offset = isLeftHand ? 0 : (ROWS_PER_HAND);
+    bool changed = false;
 #if (DIODE_DIRECTION == COL2ROW)
     // Set row, read cols
     for (uint8_t current_row = 0; current_row < ROWS_PER_HAND; current_row++) {
-#       if (DEBOUNCING_DELAY > 0)
-            bool matrix_changed = read_cols_on_row(matrix_debouncing+offset, current_row);
-
-            if (matrix_changed) {
-                debouncing = true;
-                debouncing_time = timer_read();
-            }
-
-#       else
-            read_cols_on_row(matrix+offset, current_row);
-#       endif
-
+        changed |= read_cols_on_row(raw_matrix+offset, current_row);
     }
-
 #elif (DIODE_DIRECTION == ROW2COL)
     // Set col, read rows
     for (uint8_t current_col = 0; current_col < MATRIX_COLS; current_col++) {
-#       if (DEBOUNCING_DELAY > 0)
-            bool matrix_changed = read_rows_on_col(matrix_debouncing+offset, current_col);
-            if (matrix_changed) {
-                debouncing = true;
-                debouncing_time = timer_read();
-            }
-#       else
-             read_rows_on_col(matrix+offset, current_col);
-#       endif
-
+        changed |= read_rows_on_col(raw_matrix+offset, current_col);
     }
 #endif
 
-#   if (DEBOUNCING_DELAY > 0)
-        if (debouncing && (timer_elapsed(debouncing_time) > DEBOUNCING_DELAY)) {
-            for (uint8_t i = 0; i < ROWS_PER_HAND; i++) {
-                matrix[i+offset] = matrix_debouncing[i+offset];
-            }
-            debouncing = false;
-        }
-#   endif
+    debounce(raw_matrix+offset, matrix+offset, ROWS_PER_HAND, changed);
 
     return 1;
 }
@@ -275,6 +260,48 @@ i2c_error: // the cable is disconnceted, or something else went wrong
     return 0;
 }
 
+#elif defined(SPLIT_SERIAL_FRAMED)
+
+int serial_transaction(void) {
+    int slaveOffset = (isLeftHand) ? (ROWS_PER_HAND) : 0;
+    uint8_t slave_frame[SPLIT_SLAVE_FRAME_MAX];
+    uint8_t master_frame[SPLIT_MASTER_FRAME_MAX];
+
+    #ifdef BACKLIGHT_ENABLE
+        split_master_set_backlight(&split_master, backlight_config.enable ? backlight_config.level : 0);
+    #endif
+
+    #ifdef RGBLIGHT_ENABLE
+        if (RGB_DIRTY) {
+            split_master_set_rgblight(&split_master, eeconfig_read_rgblight());
+            RGB_DIRTY = false;
+        }
+    #endif
+
+    split_master_build_frame(&split_master, master_frame);
+    int ret = serial_transfer_frames(slave_frame, master_frame);
+    if (!ret && !split_master_receive_frame(&split_master, slave_frame, timer_read())) {
+        ret = 1;
+    }
+
+    // Events queued by earlier frames still need to be applied when this
+    // transaction failed
+    split_master_apply_events(&split_master);
+    for (int i = 0; i < ROWS_PER_HAND; ++i) {
+        matrix[slaveOffset+i] = split_master.rows[i];
+    }
+
+    return ret;
+}
+
+uint16_t matrix_get_key_time(uint8_t row, uint8_t col) {
+    int slaveOffset = (isLeftHand) ? (ROWS_PER_HAND) : 0;
+    if (row < slaveOffset || row >= slaveOffset + ROWS_PER_HAND) {
+        return 0;
+    }
+    return split_master_key_time(&split_master, row - slaveOffset, col);
+}
+
 #else // USE_SERIAL
 
 int serial_transaction(void) {
@@ -319,6 +346,9 @@ uint8_t matrix_scan(void)
             for (int i = 0; i < ROWS_PER_HAND; ++i) {
                 matrix[slaveOffset+i] = 0;
             }
+#ifdef SPLIT_SERIAL_FRAMED
+            split_master_resync(&split_master);
+#endif
         }
     } else {
         error_count = 0;
@@ -336,6 +366,21 @@ void matrix_slave_scan(void) {
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
         i2c_slave_buffer[I2C_KEYMAP_START+i] = matrix[offset+i];
     }   
+#elif defined(SPLIT_SERIAL_FRAMED)
+    uint8_t frame[SPLIT_MASTER_FRAME_MAX];
+    if (serial_slave_get_frame(frame)) {
+        split_slave_receive_frame(&split_slave, frame);
+    }
+    // Every scan queues its changes with their own time, so the master
+    // sees when they happened rather than when it asked for them
+    split_slave_scan(&split_slave, &matrix[offset], timer_read());
+    // The frame takes events off the queue, so only build the next one
+    // once the previous one is gone
+    if (serial_slave_frame_sent()) {
+        uint8_t slave_frame[SPLIT_SLAVE_FRAME_MAX];
+        split_slave_build_frame(&split_slave, timer_read(), slave_frame);
+        serial_slave_set_frame(slave_frame);
+    }
 #else // USE_SERIAL
     for (int i = 0; i < ROWS_PER_HAND; ++i) {
         serial_slave_buffer[i] = matrix[offset+i];
@@ -346,7 +391,7 @@ void matrix_slave_scan(void) {
 
 bool matrix_is_modified(void)
 {
-    if (debouncing) return false;
+    if (debounce_active()) return false;
     return true;
 }
 
@@ -385,40 +430,85 @@ uint8_t matrix_key_count(void)
 
 static void init_cols(void)
 {
+    col_port_count = 0;
     for(uint8_t x = 0; x < MATRIX_COLS; x++) {
         uint8_t pin = col_pins[x];
         _SFR_IO8((pin >> 4) + 1) &= ~_BV(pin & 0xF); // IN
         _SFR_IO8((pin >> 4) + 2) |=  _BV(pin & 0xF); // HI
+
+        uint8_t port = 0;
+        while (port < col_port_count && col_port_addr[port] != (pin >> 4)) {
+            port++;
+        }
+        if (port == col_port_count) {
+            col_port_addr[port] = pin >> 4;
+            col_port_mask[port] = 0;
+            col_port_count++;
+        }
+        col_port[x] = port;
+        col_mask[x] = _BV(pin & 0xF);
+        col_port_mask[port] |= col_mask[x];
     }
 }
 
+#ifdef MATRIX_IO_DELAY_ADAPTIVE
+/* Waits until the cols of the keys held on the last row have been pulled
+ * back up, which is usually right away as no keys are held
+ */
+static void wait_cols_high(void)
+{
+    for (uint16_t us = 0; us < MATRIX_IO_DELAY; us++) {
+        bool high = true;
+        for (uint8_t port = 0; port < col_port_count; port++) {
+            if ((_SFR_IO8(col_port_addr[port]) & col_port_mask[port]) != col_port_mask[port]) {
+                high = false;
+            }
+        }
+        if (high) {
+            return;
+        }
+        wait_us(1);
+    }
+}
+#endif
+
 static bool read_cols_on_row(matrix_row_t current_matrix[], uint8_t current_row)
 {
     // Store last value of row prior to reading
     matrix_row_t last_row_value = current_matrix[current_row];
 
-    // Clear data in matrix row
-    current_matrix[current_row] = 0;
-
     // Select row and wait for row selecton to stabilize
     select_row(current_row);
-    wait_us(30);
-
-    // For each col...
-    for(uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
+#ifdef MATRIX_IO_DELAY_ADAPTIVE
+    wait_us(1);
+#else
+    wait_us(MATRIX_IO_DELAY);
+#endif
 
-        // Select the col pin to read (active low)
-        uint8_t pin = col_pins[col_index];
-        uint8_t pin_state = (_SFR_IO8(pin >> 4) & _BV(pin & 0xF));
+    // Read each port once
+    uint8_t port_state[COL_PORTS_MAX];
+    for (uint8_t port = 0; port < col_port_count; port++) {
+        port_state[port] = _SFR_IO8(col_port_addr[port]);
+    }
 
-        // Populate the matrix row with the state of the col pin
-        current_matrix[current_row] |=  pin_state ? 0 : (ROW_SHIFTER << col_index);
+    // Populate the matrix row with the state of the col pins (active low)
+    matrix_row_t row = 0;
+    matrix_row_t col_bit = ROW_SHIFTER;
+    for(uint8_t col_index = 0; col_index < MATRIX_COLS; col_index++) {
+        if (!(port_state[col_port[col_index]] & col_mask[col_index])) {
+            row |= col_bit;
+        }
+        col_bit <<= 1;
     }
+    current_matrix[current_row] = row;
 
     // Unselect row
     unselect_row(current_row);
+#ifdef MATRIX_IO_DELAY_ADAPTIVE
+    wait_cols_high();
+#endif
 
-    return (last_row_value != current_matrix[current_row]);
+    return (last_row_value != row);
 }
 
 static void select_row(uint8_t row)
@@ -461,7 +551,7 @@ static bool read_rows_on_col(matrix_row_t current_matrix[], uint8_t current_col)
 
     // Select col and wait for col selecton to stabilize
     select_col(current_col);
-    wait_us(30);
+    wait_us(MATRIX_IO_DELAY);
 
     // For each row...
     for(uint8_t row_index = 0; row_index < ROWS_PER_HAND; row_index++)
@@ -15,13 +15,29 @@
 #ifndef USE_I2C
 
 // Serial pulse period in microseconds. Its probably a bad idea to lower this
-// value.
-#define SERIAL_DELAY 24
+// value. The framed link checks every frame with a CRC and recovers from
+// errors, so it can be tried lower there, but that hasn't been tested on
+// hardware.
+#ifndef SERIAL_DELAY
+#  define SERIAL_DELAY 24
+#endif
+
+#ifdef SPLIT_SERIAL_FRAMED
+// The frame the slave sends next, and the last one it received. Each starts
+// with its length.
+static uint8_t volatile serial_slave_frame[SPLIT_SLAVE_FRAME_MAX] = {0};
+static uint8_t volatile serial_master_frame[SPLIT_MASTER_FRAME_MAX] = {0};
 
+split_master_t split_master;
+split_slave_t split_slave;
+#else
 uint8_t volatile serial_slave_buffer[SERIAL_SLAVE_BUFFER_LENGTH] = {0};
 uint8_t volatile serial_master_buffer[SERIAL_MASTER_BUFFER_LENGTH] = {0};
+#endif
 
 #define SLAVE_DATA_CORRUPT (1<<0)
+#define SLAVE_FRAME_SENT (1<<1)
+#define SLAVE_FRAME_RECEIVED (1<<2)
 volatile uint8_t status = 0;
 
 inline static
@@ -57,11 +73,19 @@ void serial_high(void) {
 }
 
 void serial_master_init(void) {
+#ifdef SPLIT_SERIAL_FRAMED
+  split_master_init(&split_master);
+#endif
   serial_output();
   serial_high();
 }
 
 void serial_slave_init(void) {
+#ifdef SPLIT_SERIAL_FRAMED
+  split_slave_init(&split_slave);
+  // Nothing is waiting to be sent, so the first scan builds a frame
+  status |= SLAVE_FRAME_SENT;
+#endif
   serial_input();
 
   // Enable INT0
@@ -120,6 +144,128 @@ void serial_write_byte(uint8_t data) {
   }
 }
 
+#ifdef SPLIT_SERIAL_FRAMED
+
+// Sends the frame in serial_slave_frame, and then receives the master's
+// frame. The contents are checked by split_protocol.
+ISR(SERIAL_PIN_INTERRUPT) {
+  sync_send();
+
+  uint8_t length = serial_slave_frame[0];
+  serial_write_byte(length);
+  sync_send();
+  for (uint8_t i = 1; i < length; ++i) {
+    serial_write_byte(serial_slave_frame[i]);
+    sync_send();
+  }
+
+  // wait for the sync to finish sending
+  serial_delay();
+
+  // read the middle of pulses
+  _delay_us(SERIAL_DELAY/2);
+
+  length = serial_read_byte();
+  sync_send();
+  if (length > SPLIT_MASTER_FRAME_MAX) {
+    length = SPLIT_MASTER_FRAME_MAX;
+  }
+  serial_master_frame[0] = length;
+  for (uint8_t i = 1; i < length; ++i) {
+    serial_master_frame[i] = serial_read_byte();
+    sync_send();
+  }
+
+  serial_input(); // end transaction
+
+  status |= SLAVE_FRAME_SENT | SLAVE_FRAME_RECEIVED;
+}
+
+bool serial_slave_frame_sent(void) {
+  return status & SLAVE_FRAME_SENT;
+}
+
+void serial_slave_set_frame(const uint8_t *frame) {
+  cli();
+  for (uint8_t i = 0; i < frame[0]; ++i) {
+    serial_slave_frame[i] = frame[i];
+  }
+  status &= ~SLAVE_FRAME_SENT;
+  sei();
+}
+
+bool serial_slave_get_frame(uint8_t *frame) {
+  cli();
+  bool received = status & SLAVE_FRAME_RECEIVED;
+  if (received) {
+    for (uint8_t i = 0; i < serial_master_frame[0]; ++i) {
+      frame[i] = serial_master_frame[i];
+    }
+    status &= ~SLAVE_FRAME_RECEIVED;
+  }
+  sei();
+  return received;
+}
+
+// Receives a frame from the slave into slave_frame, and sends master_frame
+// to the slave.
+//
+// Returns:
+// 0 => no error
+// 1 => slave did not respond, or sent a frame that is too long
+int serial_transfer_frames(uint8_t *slave_frame, const uint8_t *master_frame) {
+  // this code is very time dependent, so we need to disable interrupts
+  cli();
+
+  // signal to the slave that we want to start a transaction
+  serial_output();
+  serial_low();
+  _delay_us(1);
+
+  // wait for the slaves response
+  serial_input();
+  serial_high();
+  _delay_us(SERIAL_DELAY);
+
+  // check if the slave is present
+  if (serial_read_pin()) {
+    // slave failed to pull the line low, assume not present
+    sei();
+    return 1;
+  }
+
+  // if the slave is present syncronize with it
+  sync_recv();
+
+  uint8_t length = serial_read_byte();
+  sync_recv();
+  if (length > SPLIT_SLAVE_FRAME_MAX) {
+    serial_output();
+    serial_high();
+    sei();
+    return 1;
+  }
+  slave_frame[0] = length;
+  for (uint8_t i = 1; i < length; ++i) {
+    slave_frame[i] = serial_read_byte();
+    sync_recv();
+  }
+
+  for (uint8_t i = 0; i < master_frame[0]; ++i) {
+    serial_write_byte(master_frame[i]);
+    sync_recv();
+  }
+
+  // always, release the line when not in use
+  serial_output();
+  serial_high();
+
+  sei();
+  return 0;
+}
+
+#else
+
 // interrupt handle to be used by the slave device
 ISR(SERIAL_PIN_INTERRUPT) {
   sync_send();
@@ -225,4 +371,6 @@ int serial_update_buffers(void) {
   return 0;
 }
 
+#endif // SPLIT_SERIAL_FRAMED
+
 #endif
@@ -11,6 +11,24 @@
 #define SERIAL_PIN_MASK _BV(PD0)
 #define SERIAL_PIN_INTERRUPT INT0_vect
 
+#ifdef SPLIT_SERIAL_FRAMED
+#include "split_protocol.h"
+
+// Protocol state of the half that is the master, or the slave
+extern split_master_t split_master;
+extern split_slave_t split_slave;
+
+void serial_master_init(void);
+void serial_slave_init(void);
+// Exchanges frames with the slave, returns 0 on success
+int serial_transfer_frames(uint8_t *slave_frame, const uint8_t *master_frame);
+// The slave sends the frame it was given once, and keeps the last one received
+bool serial_slave_frame_sent(void);
+void serial_slave_set_frame(const uint8_t *frame);
+bool serial_slave_get_frame(uint8_t *frame);
+
+#else
+
 #define SERIAL_SLAVE_BUFFER_LENGTH MATRIX_ROWS/2
 #define SERIAL_MASTER_BUFFER_LENGTH 1
 
@@ -27,3 +45,5 @@ int serial_update_buffers(void);
 bool serial_slave_data_corrupt(void);
 
 #endif
+
+#endif
@@ -0,0 +1,331 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "split_protocol.h"
+#include "progmem.h"
+#include <string.h>
+
+// CRC-8 with polynomial 0x07, processed a nibble at a time
+static const uint8_t PROGMEM crc8_table[16] = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+    0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D
+};
+
+uint8_t split_crc8(const uint8_t *data, uint8_t length) {
+    uint8_t crc = 0;
+    while (length--) {
+        crc ^= *data++;
+        crc = (crc << 4) ^ pgm_read_byte(&crc8_table[crc >> 4]);
+        crc = (crc << 4) ^ pgm_read_byte(&crc8_table[crc >> 4]);
+    }
+    return crc;
+}
+
+static void split_link_init(split_link_t *link) {
+    link->tx_seq = 0;
+    link->rx_seq = 0;
+    link->rx_synced = false;
+    // Both sides start by sending everything, and asking for everything
+    link->tx_flags = SPLIT_FRAME_FULL | SPLIT_FRAME_RESYNC;
+}
+
+// Starts a frame, the length is filled in by split_link_end_frame
+static uint8_t split_link_start_frame(split_link_t *link, uint8_t *frame, uint8_t flags) {
+    frame[1] = link->tx_seq++;
+    frame[2] = flags | link->tx_flags;
+    link->tx_flags = 0;
+    return 3;
+}
+
+static uint8_t split_link_end_frame(uint8_t *frame, uint8_t length) {
+    frame[0] = length + 1;
+    frame[length] = split_crc8(frame, length);
+    return length + 1;
+}
+
+// Checks the frame, and its place in the sequence. Returns false if the
+// contents should not be used, either because the frame is corrupt, or
+// because it's a repeat of the previous one.
+static bool split_link_receive_frame(split_link_t *link, const uint8_t *frame, uint8_t min_length, uint8_t max_length, bool *corrupt) {
+    uint8_t length = frame[0];
+    *corrupt = length < min_length || length > max_length ||
+        split_crc8(frame, length - 1) != frame[length - 1];
+    if (*corrupt) {
+        link->tx_flags |= SPLIT_FRAME_RESYNC;
+        return false;
+    }
+
+    uint8_t seq = frame[1];
+    uint8_t flags = frame[2];
+    if (flags & SPLIT_FRAME_RESYNC) {
+        link->tx_flags |= SPLIT_FRAME_FULL;
+    }
+    if (link->rx_synced && seq == link->rx_seq) {
+        return false;
+    }
+    // Frames were lost in between, so changes might be missing
+    if (!(flags & SPLIT_FRAME_FULL) && (!link->rx_synced || seq != (uint8_t)(link->rx_seq + 1))) {
+        link->tx_flags |= SPLIT_FRAME_RESYNC;
+    }
+    link->rx_seq = seq;
+    link->rx_synced = true;
+    return true;
+}
+
+void split_slave_init(split_slave_t *slave) {
+    memset(slave, 0, sizeof(*slave));
+    split_link_init(&slave->link);
+}
+
+void split_slave_scan(split_slave_t *slave, const matrix_row_t *rows, uint16_t now) {
+    for (uint8_t row = 0; row < SPLIT_ROWS_PER_HAND; row++) {
+        matrix_row_t changed = rows[row] ^ slave->rows[row];
+        if (!changed) {
+            continue;
+        }
+        for (uint8_t col = 0; col < sizeof(matrix_row_t) * 8; col++) {
+            matrix_row_t bit = (matrix_row_t)1 << col;
+            if (!(changed & bit)) {
+                continue;
+            }
+            if (slave->event_count == SPLIT_EVENT_QUEUE_SIZE) {
+                // The rows in the next full frame replace the lost events
+                slave->link.tx_flags |= SPLIT_FRAME_FULL;
+                continue;
+            }
+            slave->events[slave->event_count++] = (split_event_t){
+                .row = row,
+                .col = col,
+                .pressed = rows[row] & bit,
+                .time = now
+            };
+        }
+        slave->rows[row] = rows[row];
+    }
+}
+
+uint8_t split_slave_build_frame(split_slave_t *slave, uint16_t now, uint8_t *frame) {
+    bool full = slave->link.tx_flags & SPLIT_FRAME_FULL;
+    uint8_t length = split_link_start_frame(&slave->link, frame, 0);
+    frame[length++] = now;
+    frame[length++] = now >> 8;
+    if (full) {
+        for (uint8_t i = 0; i < SPLIT_ROWS_PER_HAND; i++) {
+            for (uint8_t b = 0; b < sizeof(matrix_row_t); b++) {
+                frame[length++] = slave->rows[i] >> (b * 8);
+            }
+        }
+        slave->event_count = 0;
+    }
+
+    uint8_t count = slave->event_count < SPLIT_EVENTS_PER_FRAME ? slave->event_count : SPLIT_EVENTS_PER_FRAME;
+    frame[length++] = count;
+    for (uint8_t i = 0; i < count; i++) {
+        const split_event_t *event = &slave->events[i];
+        uint16_t age = now - event->time;
+        frame[length++] = (event->pressed ? 0x80 : 0) | event->row;
+        frame[length++] = event->col;
+        frame[length++] = age > 255 ? 255 : age;
+    }
+    slave->event_count -= count;
+    memmove(slave->events, &slave->events[count], slave->event_count * sizeof(split_event_t));
+    return split_link_end_frame(frame, length);
+}
+
+bool split_slave_receive_frame(split_slave_t *slave, const uint8_t *frame) {
+    bool corrupt;
+    if (!split_link_receive_frame(&slave->link, frame, 4, SPLIT_MASTER_FRAME_MAX, &corrupt)) {
+        return !corrupt;
+    }
+
+    uint8_t flags = frame[2];
+    uint8_t length = frame[0];
+    uint8_t i = 3;
+    if (flags & SPLIT_FRAME_BACKLIGHT) {
+        if (i + 1 >= length) {
+            slave->link.tx_flags |= SPLIT_FRAME_RESYNC;
+            return false;
+        }
+        slave->backlight = frame[i++];
+        slave->backlight_updated = true;
+    }
+    if (flags & SPLIT_FRAME_RGBLIGHT) {
+        if (i + 4 >= length) {
+            slave->link.tx_flags |= SPLIT_FRAME_RESYNC;
+            return false;
+        }
+        slave->rgblight = 0;
+        for (uint8_t b = 0; b < 4; b++) {
+            slave->rgblight |= (uint32_t)frame[i++] << (b * 8);
+        }
+        slave->rgblight_updated = true;
+    }
+    return true;
+}
+
+void split_master_init(split_master_t *master) {
+    memset(master, 0, sizeof(*master));
+    split_link_init(&master->link);
+}
+
+void split_master_set_backlight(split_master_t *master, uint8_t level) {
+    if (!(master->present & SPLIT_FRAME_BACKLIGHT) || master->backlight != level) {
+        master->backlight = level;
+        master->present |= SPLIT_FRAME_BACKLIGHT;
+        master->dirty |= SPLIT_FRAME_BACKLIGHT;
+    }
+}
+
+void split_master_set_rgblight(split_master_t *master, uint32_t rgblight) {
+    if (!(master->present & SPLIT_FRAME_RGBLIGHT) || master->rgblight != rgblight) {
+        master->rgblight = rgblight;
+        master->present |= SPLIT_FRAME_RGBLIGHT;
+        master->dirty |= SPLIT_FRAME_RGBLIGHT;
+    }
+}
+
+uint8_t split_master_build_frame(split_master_t *master, uint8_t *frame) {
+    uint8_t send = master->dirty;
+    if (master->link.tx_flags & SPLIT_FRAME_FULL) {
+        send = master->present;
+    }
+    master->dirty = 0;
+    uint8_t length = split_link_start_frame(&master->link, frame, send);
+    if (send & SPLIT_FRAME_BACKLIGHT) {
+        frame[length++] = master->backlight;
+    }
+    if (send & SPLIT_FRAME_RGBLIGHT) {
+        for (uint8_t b = 0; b < 4; b++) {
+            frame[length++] = master->rgblight >> (b * 8);
+        }
+    }
+    return split_link_end_frame(frame, length);
+}
+
+// Tracks the smallest difference between the clocks seen in a frame. It
+// slowly creeps up, so that it follows a slave clock that runs slow.
+static void split_master_update_clock_offset(split_master_t *master, uint16_t slave_time, uint16_t now) {
+    uint16_t offset = now - slave_time;
+    if (!master->clock_offset_valid || (int16_t)(offset - master->clock_offset) < 0) {
+        master->clock_offset = offset;
+        master->clock_offset_valid = true;
+        master->clock_offset_age = 0;
+    } else if (++master->clock_offset_age == 0) {
+        master->clock_offset++;
+    }
+}
+
+bool split_master_receive_frame(split_master_t *master, const uint8_t *frame, uint16_t now) {
+    bool corrupt;
+    if (!split_link_receive_frame(&master->link, frame, 7, SPLIT_SLAVE_FRAME_MAX, &corrupt)) {
+        return !corrupt;
+    }
+
+    uint8_t flags = frame[2];
+    uint8_t length = frame[0];
+    uint16_t slave_time = frame[3] | (uint16_t)frame[4] << 8;
+    uint8_t i = 5;
+    split_master_update_clock_offset(master, slave_time, now);
+
+    if (flags & SPLIT_FRAME_FULL) {
+        // The rows are followed by the event count
+        if (i + SPLIT_ROWS_PER_HAND * sizeof(matrix_row_t) + 1 >= length) {
+            master->link.tx_flags |= SPLIT_FRAME_RESYNC;
+            return false;
+        }
+        for (uint8_t row = 0; row < SPLIT_ROWS_PER_HAND; row++) {
+            matrix_row_t value = 0;
+            for (uint8_t b = 0; b < sizeof(matrix_row_t); b++) {
+                value |= (matrix_row_t)frame[i++] << (b * 8);
+            }
+            master->rows[row] = value;
+        }
+        master->pending_count = 0;
+    }
+
+    uint8_t count = frame[i++];
+    if (i + count * SPLIT_EVENT_SIZE >= length ||
+        master->pending_count + count > SPLIT_EVENT_QUEUE_SIZE) {
+        master->link.tx_flags |= SPLIT_FRAME_RESYNC;
+        return false;
+    }
+    for (uint8_t e = 0; e < count; e++) {
+        uint8_t row = frame[i] & 0x7F;
+        uint8_t col = frame[i + 1];
+        if (row >= SPLIT_ROWS_PER_HAND || col >= sizeof(matrix_row_t) * 8) {
+            master->link.tx_flags |= SPLIT_FRAME_RESYNC;
+            return false;
+        }
+        uint16_t time = slave_time - frame[i + 2] + master->clock_offset;
+        // The offset is only an estimate, don't let it put events in the future
+        if ((int16_t)(now - time) < 0) {
+            time = now;
+        }
+        master->pending[master->pending_count++] = (split_event_t){
+            .row = row,
+            .col = col,
+            .pressed = frame[i] & 0x80,
+            .time = time
+        };
+        i += SPLIT_EVENT_SIZE;
+    }
+    return true;
+}
+
+void split_master_apply_events(split_master_t *master) {
+    uint8_t count = 0;
+    master->applied_count = 0;
+    while (count < master->pending_count) {
+        const split_event_t *event = &master->pending[count];
+        bool seen = false;
+        for (uint8_t i = 0; i < master->applied_count; i++) {
+            if (master->applied[i].row == event->row && master->applied[i].col == event->col) {
+                seen = true;
+                break;
+            }
+        }
+        if (seen) {
+            break;
+        }
+        matrix_row_t bit = (matrix_row_t)1 << event->col;
+        if (event->pressed) {
+            master->rows[event->row] |= bit;
+        } else {
+            master->rows[event->row] &= ~bit;
+        }
+        master->applied[master->applied_count++] = *event;
+        count++;
+    }
+    master->pending_count -= count;
+    memmove(master->pending, &master->pending[count], master->pending_count * sizeof(split_event_t));
+}
+
+uint16_t split_master_key_time(const split_master_t *master, uint8_t row, uint8_t col) {
+    for (uint8_t i = 0; i < master->applied_count; i++) {
+        if (master->applied[i].row == row && master->applied[i].col == col) {
+            return master->applied[i].time | 1;
+        }
+    }
+    return 0;
+}
+
+void split_master_resync(split_master_t *master) {
+    memset(master->rows, 0, sizeof(master->rows));
+    master->pending_count = 0;
+    master->applied_count = 0;
+    master->link.rx_synced = false;
+    master->link.tx_flags |= SPLIT_FRAME_RESYNC;
+}
@@ -0,0 +1,147 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPLIT_PROTOCOL_H
+#define SPLIT_PROTOCOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "matrix.h"
+
+/*
+ * Framing for the split keyboard serial link, see SPLIT_SERIAL_FRAMED.
+ *
+ * Every transaction carries one frame from the slave followed by one from
+ * the master. Both start with their length and end with a CRC8:
+ *
+ *   slave:  length, sequence, flags, time x2, [rows...], event count, events..., crc
+ *   master: length, sequence, flags, [backlight], [rgblight x4], crc
+ *
+ * The slave scans all the time, and queues every key change with the time
+ * it saw it. Frames carry the queued events, each with its age relative to
+ * the time in the frame, and the master turns that into its own time. The
+ * rows are only sent in full frames. The master only sends the backlight
+ * and rgblight state when it changes. When either side receives a corrupt
+ * frame, or sees a gap in the sequence numbers, it asks the other side for
+ * a full frame with everything in it.
+ */
+
+#define SPLIT_ROWS_PER_HAND (MATRIX_ROWS / 2)
+
+#if defined(SPLIT_SERIAL_FRAMED) && SPLIT_ROWS_PER_HAND > 8
+#   error "The split protocol supports at most 8 rows per hand"
+#endif
+
+// Key changes the slave can hold while it waits for the master
+#ifndef SPLIT_EVENT_QUEUE_SIZE
+#   define SPLIT_EVENT_QUEUE_SIZE 8
+#endif
+// Key changes sent in one frame, the rest wait for the next one
+#ifndef SPLIT_EVENTS_PER_FRAME
+#   define SPLIT_EVENTS_PER_FRAME 4
+#endif
+
+// The frame contains all the state instead of only the changes
+#define SPLIT_FRAME_FULL      (1 << 0)
+// The sender lost track of the other side, and needs a full frame
+#define SPLIT_FRAME_RESYNC    (1 << 1)
+#define SPLIT_FRAME_BACKLIGHT (1 << 2)
+#define SPLIT_FRAME_RGBLIGHT  (1 << 3)
+
+#define SPLIT_EVENT_SIZE 3
+#define SPLIT_SLAVE_FRAME_MAX  (7 + SPLIT_ROWS_PER_HAND * sizeof(matrix_row_t) + SPLIT_EVENTS_PER_FRAME * SPLIT_EVENT_SIZE)
+#define SPLIT_MASTER_FRAME_MAX (4 + 1 + 4)
+
+typedef struct {
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+    // When the key changed, in the clock of the side that holds the event
+    uint16_t time;
+} split_event_t;
+
+typedef struct {
+    uint8_t tx_seq;
+    uint8_t rx_seq;
+    // A frame was received, so rx_seq is valid
+    bool rx_synced;
+    // Flags for the next frame, SPLIT_FRAME_FULL and SPLIT_FRAME_RESYNC
+    uint8_t tx_flags;
+} split_link_t;
+
+typedef struct {
+    split_link_t link;
+    // The rows as of the last scan
+    matrix_row_t rows[SPLIT_ROWS_PER_HAND];
+    // Changes the master hasn't been sent yet
+    split_event_t events[SPLIT_EVENT_QUEUE_SIZE];
+    uint8_t event_count;
+    // State received from the master, the updated flags are for the caller to clear
+    uint8_t backlight;
+    uint32_t rgblight;
+    bool backlight_updated;
+    bool rgblight_updated;
+} split_slave_t;
+
+typedef struct {
+    split_link_t link;
+    // The rows of the slave half, with the events applied so far
+    matrix_row_t rows[SPLIT_ROWS_PER_HAND];
+    // Received events that haven't been applied yet, in master time
+    split_event_t pending[SPLIT_EVENT_QUEUE_SIZE];
+    uint8_t pending_count;
+    // The events applied by the last split_master_apply_events
+    split_event_t applied[SPLIT_EVENT_QUEUE_SIZE];
+    uint8_t applied_count;
+    // Master time minus slave time, the smallest seen so far since the
+    // frames can only be delayed
+    uint16_t clock_offset;
+    bool clock_offset_valid;
+    uint8_t clock_offset_age;
+    uint8_t backlight;
+    uint32_t rgblight;
+    // SPLIT_FRAME_BACKLIGHT and SPLIT_FRAME_RGBLIGHT, for the state that has
+    // been set at all, and for the state that changed since the last frame
+    uint8_t present;
+    uint8_t dirty;
+} split_master_t;
+
+uint8_t split_crc8(const uint8_t *data, uint8_t length);
+
+void split_slave_init(split_slave_t *slave);
+// Queues the changes between the rows and the previous scan
+void split_slave_scan(split_slave_t *slave, const matrix_row_t *rows, uint16_t now);
+// Builds the next frame, returns its length
+uint8_t split_slave_build_frame(split_slave_t *slave, uint16_t now, uint8_t *frame);
+// Handles a frame from the master, returns false if it was corrupt
+bool split_slave_receive_frame(split_slave_t *slave, const uint8_t *frame);
+
+void split_master_init(split_master_t *master);
+void split_master_set_backlight(split_master_t *master, uint8_t level);
+void split_master_set_rgblight(split_master_t *master, uint32_t rgblight);
+// Builds the next frame for the slave, returns its length
+uint8_t split_master_build_frame(split_master_t *master, uint8_t *frame);
+// Handles a frame from the slave and queues its events, returns false if it was corrupt
+bool split_master_receive_frame(split_master_t *master, const uint8_t *frame, uint16_t now);
+// Applies the pending events to rows, stopping before a key that already
+// changed, so that every change is seen by one scan
+void split_master_apply_events(split_master_t *master);
+// The time of the key's change in the last split_master_apply_events, or 0
+uint16_t split_master_key_time(const split_master_t *master, uint8_t row, uint8_t col);
+// Forgets the slave rows and asks for all of them again, after the link was lost
+void split_master_resync(split_master_t *master);
+
+#endif
@@ -105,7 +105,12 @@ void keyboard_slave_loop(void) {
     matrix_slave_scan();
     
     // Read Backlight Info
-    #ifdef BACKLIGHT_ENABLE
+    #if defined(BACKLIGHT_ENABLE) && defined(SPLIT_SERIAL_FRAMED)
+        if (split_slave.backlight_updated) {
+            backlight_set(split_slave.backlight);
+            split_slave.backlight_updated = false;
+        }
+    #elif defined(BACKLIGHT_ENABLE)
         if (BACKLIT_DIRTY) {
             #ifdef USE_I2C
                 backlight_set(i2c_slave_buffer[I2C_BACKLIT_START]);
@@ -136,6 +141,11 @@ void keyboard_slave_loop(void) {
                 // Re-enable interupts now that RGB is set
                 sei();
             }
+        #elif defined(SPLIT_SERIAL_FRAMED)
+            if (split_slave.rgblight_updated) {
+                rgblight_update_dword(split_slave.rgblight);
+                split_slave.rgblight_updated = false;
+            }
         #else // USE_SERIAL
             // Add serial implementation for RGB here
         #endif
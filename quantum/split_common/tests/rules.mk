@@ -0,0 +1,5 @@
+split_protocol_DEFS := -DMATRIX_ROWS=8 -DMATRIX_COLS=8 -DSPLIT_SERIAL_FRAMED
+
+split_protocol_SRC := \
+	$(QUANTUM_PATH)/split_common/tests/split_protocol_tests.cpp \
+	$(QUANTUM_PATH)/split_common/split_protocol.c
@@ -0,0 +1,387 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <stdio.h>
+extern "C" {
+#include "split_common/split_protocol.h"
+}
+
+namespace {
+    // Each byte on the wire takes eight bits and a sync pulse
+    const uint32_t LEGACY_BIT_US = 24;
+    const uint32_t FRAMED_BIT_US = 8;
+
+    uint32_t wire_time_us(uint32_t bytes, uint32_t bit_us) {
+        return bytes * 9 * bit_us;
+    }
+
+    uint8_t reference_crc8(const uint8_t* data, uint8_t length) {
+        uint8_t crc = 0;
+        while (length--) {
+            crc ^= *data++;
+            for (int i = 0; i < 8; i++) {
+                crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+            }
+        }
+        return crc;
+    }
+}
+
+class SplitProtocol : public ::testing::Test {
+public:
+    SplitProtocol() {
+        split_slave_init(&slave);
+        split_master_init(&master);
+        memset(rows, 0, sizeof(rows));
+        corrupt_slave_frame = false;
+        corrupt_master_frame = false;
+        drop_transaction = false;
+    }
+
+    // One transaction: the slave's frame goes to the master, then the
+    // master's frame goes to the slave. The slave builds its next frame
+    // after the transaction, like the firmware does. Every transaction
+    // takes a millisecond.
+    void transaction() {
+        uint8_t master_frame[SPLIT_MASTER_FRAME_MAX];
+        scan_slave();
+        split_master_build_frame(&master, master_frame);
+        if (slave_frame_length == 0) {
+            build_slave_frame();
+        }
+        if (drop_transaction) {
+            drop_transaction = false;
+            slave_frame_length = 0;
+            return;
+        }
+        if (corrupt_slave_frame) {
+            slave_frame[slave_frame_length - 2] ^= 0x10;
+            corrupt_slave_frame = false;
+        }
+        if (corrupt_master_frame) {
+            master_frame[1] ^= 0x01;
+            corrupt_master_frame = false;
+        }
+        slave_bytes = slave_frame[0];
+        master_bytes = master_frame[0];
+        master_ok = split_master_receive_frame(&master, slave_frame, now + link_delay);
+        slave_ok = split_slave_receive_frame(&slave, master_frame);
+        split_master_apply_events(&master);
+        slave_frame_length = 0;
+        now++;
+    }
+
+    void scan_slave() {
+        split_slave_scan(&slave, rows, now + slave_clock);
+    }
+
+    void build_slave_frame() {
+        slave_frame_length = split_slave_build_frame(&slave, now + slave_clock, slave_frame);
+    }
+
+    bool rows_match() {
+        return memcmp(rows, master.rows, sizeof(rows)) == 0;
+    }
+
+    split_slave_t slave;
+    split_master_t master;
+    // Master time, the slave's clock runs at an offset from it
+    uint16_t now = 1000;
+    uint16_t slave_clock = 0;
+    // Time between building the slave's frame and the master receiving it
+    uint16_t link_delay = 0;
+    matrix_row_t rows[SPLIT_ROWS_PER_HAND];
+    uint8_t slave_frame[SPLIT_SLAVE_FRAME_MAX];
+    uint8_t slave_frame_length = 0;
+    uint8_t slave_bytes = 0;
+    uint8_t master_bytes = 0;
+    bool master_ok = false;
+    bool slave_ok = false;
+    bool corrupt_slave_frame;
+    bool corrupt_master_frame;
+    bool drop_transaction;
+};
+
+TEST_F(SplitProtocol, Crc8MatchesTheBitwiseReference) {
+    uint8_t data[64];
+    for (int i = 0; i < 64; i++) {
+        data[i] = i * 37 + 11;
+    }
+    for (int length = 0; length <= 64; length++) {
+        EXPECT_EQ(split_crc8(data, length), reference_crc8(data, length)) << "length " << length;
+    }
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    EXPECT_EQ(split_crc8(check, sizeof(check)), 0xF4);
+}
+
+TEST_F(SplitProtocol, TheFirstFramesContainEverything) {
+    rows[1] = 0x81;
+    transaction();
+    EXPECT_TRUE(master_ok);
+    EXPECT_TRUE(slave_ok);
+    EXPECT_EQ(slave_bytes, 7 + SPLIT_ROWS_PER_HAND);
+    EXPECT_TRUE(rows_match());
+}
+
+TEST_F(SplitProtocol, OnlyChangesAreSent) {
+    transaction();
+    transaction();
+    transaction();
+    EXPECT_EQ(slave_bytes, 7);
+    rows[2] = 0x04;
+    transaction();
+    EXPECT_TRUE(master_ok);
+    EXPECT_EQ(slave_bytes, 7 + SPLIT_EVENT_SIZE);
+    EXPECT_TRUE(rows_match());
+    rows[0] = 0x01;
+    rows[3] = 0x02;
+    rows[2] = 0;
+    transaction();
+    EXPECT_EQ(slave_bytes, 7 + 3 * SPLIT_EVENT_SIZE);
+    EXPECT_TRUE(rows_match());
+    transaction();
+    EXPECT_EQ(slave_bytes, 7);
+    EXPECT_TRUE(rows_match());
+}
+
+TEST_F(SplitProtocol, EventsKeepTheTimeTheSlaveSawThem) {
+    slave_clock = 5000;
+    link_delay = 2;
+    for (int i = 0; i < 5; i++) {
+        transaction();
+    }
+    uint16_t pressed = now;
+    rows[1] = 0x10;
+    scan_slave();
+    // The master only hears about it a few transactions later
+    now += 20;
+    transaction();
+    EXPECT_TRUE(rows_match());
+    EXPECT_EQ(split_master_key_time(&master, 1, 4), (uint16_t)((pressed + link_delay) | 1));
+    EXPECT_EQ(split_master_key_time(&master, 1, 3), 0);
+    transaction();
+    EXPECT_EQ(split_master_key_time(&master, 1, 4), 0);
+}
+
+TEST_F(SplitProtocol, TheClockOffsetFollowsTheShortestDelay) {
+    slave_clock = 0x8000;
+    link_delay = 7;
+    transaction();
+    EXPECT_EQ(master.clock_offset, (uint16_t)(link_delay - slave_clock));
+    link_delay = 1;
+    transaction();
+    EXPECT_EQ(master.clock_offset, (uint16_t)(link_delay - slave_clock));
+    link_delay = 5;
+    for (int i = 0; i < 10; i++) {
+        transaction();
+    }
+    EXPECT_EQ(master.clock_offset, (uint16_t)(1 - slave_clock));
+}
+
+TEST_F(SplitProtocol, EventsAreNeverInTheFuture) {
+    slave_clock = 100;
+    link_delay = 3;
+    transaction();
+    transaction();
+    // The slave clock jumps ahead, so the estimate is off
+    slave_clock = 200;
+    rows[0] = 0x01;
+    transaction();
+    EXPECT_TRUE(rows_match());
+    EXPECT_EQ(split_master_key_time(&master, 0, 0), (uint16_t)((now - 1 + link_delay) | 1));
+}
+
+TEST_F(SplitProtocol, ATapWithinOneFrameIsSeenByTwoScans) {
+    transaction();
+    transaction();
+    rows[2] = 0x01;
+    scan_slave();
+    rows[2] = 0;
+    transaction();
+    EXPECT_EQ(master.rows[2], 0x01);
+    EXPECT_NE(split_master_key_time(&master, 2, 0), 0);
+    split_master_apply_events(&master);
+    EXPECT_EQ(master.rows[2], 0);
+    EXPECT_NE(split_master_key_time(&master, 2, 0), 0);
+    split_master_apply_events(&master);
+    EXPECT_EQ(split_master_key_time(&master, 2, 0), 0);
+}
+
+TEST_F(SplitProtocol, EventsBeyondOneFrameWaitForTheNext) {
+    transaction();
+    transaction();
+    rows[0] = 0xFF;
+    transaction();
+    EXPECT_EQ(slave_bytes, 7 + SPLIT_EVENTS_PER_FRAME * SPLIT_EVENT_SIZE);
+    EXPECT_EQ(master.rows[0], 0x0F);
+    transaction();
+    EXPECT_TRUE(rows_match());
+}
+
+TEST_F(SplitProtocol, AFullQueueSendsAFullFrame) {
+    transaction();
+    transaction();
+    for (int i = 0; i < SPLIT_EVENT_QUEUE_SIZE + 2; i++) {
+        rows[i % SPLIT_ROWS_PER_HAND] ^= 1 << (i % 8);
+        scan_slave();
+    }
+    transaction();
+    EXPECT_EQ(slave_bytes, 7 + SPLIT_ROWS_PER_HAND);
+    EXPECT_TRUE(rows_match());
+}
+
+TEST_F(SplitProtocol, BacklightAndRgblightAreSentWhenChanged) {
+    transaction();
+    transaction();
+    EXPECT_EQ(master_bytes, 4);
+    split_master_set_backlight(&master, 3);
+    transaction();
+    EXPECT_EQ(master_bytes, 5);
+    EXPECT_TRUE(slave.backlight_updated);
+    EXPECT_EQ(slave.backlight, 3);
+    slave.backlight_updated = false;
+
+    split_master_set_backlight(&master, 3);
+    transaction();
+    EXPECT_EQ(master_bytes, 4);
+    EXPECT_FALSE(slave.backlight_updated);
+
+    split_master_set_rgblight(&master, 0x12345678);
+    transaction();
+    EXPECT_EQ(master_bytes, 8);
+    EXPECT_TRUE(slave.rgblight_updated);
+    EXPECT_EQ(slave.rgblight, 0x12345678u);
+}
+
+TEST_F(SplitProtocol, TheMasterRecoversFromACorruptFrame) {
+    transaction();
+    transaction();
+    rows[0] = 0x10;
+    corrupt_slave_frame = true;
+    transaction();
+    EXPECT_FALSE(master_ok);
+    EXPECT_FALSE(rows_match());
+    // The slave built this one before it heard about the error
+    transaction();
+    EXPECT_TRUE(master_ok);
+    transaction();
+    EXPECT_TRUE(master_ok);
+    EXPECT_EQ(slave_bytes, 7 + SPLIT_ROWS_PER_HAND);
+    EXPECT_TRUE(rows_match());
+}
+
+TEST_F(SplitProtocol, TheMasterRecoversFromALostFrame) {
+    transaction();
+    transaction();
+    rows[3] = 0x20;
+    drop_transaction = true;
+    transaction();
+    transaction();
+    EXPECT_TRUE(master_ok);
+    // The master's frame is built before the transaction, so the request for
+    // a full frame only goes out in the next one
+    transaction();
+    EXPECT_FALSE(rows_match());
+    transaction();
+    EXPECT_TRUE(rows_match());
+    rows[3] = 0;
+    transaction();
+    EXPECT_TRUE(rows_match());
+}
+
+TEST_F(SplitProtocol, TheSlaveRecoversFromACorruptFrame) {
+    transaction();
+    transaction();
+    split_master_set_backlight(&master, 2);
+    corrupt_master_frame = true;
+    transaction();
+    EXPECT_FALSE(slave_ok);
+    EXPECT_FALSE(slave.backlight_updated);
+    transaction();
+    transaction();
+    EXPECT_TRUE(slave.backlight_updated);
+    EXPECT_EQ(slave.backlight, 2);
+}
+
+TEST_F(SplitProtocol, RepeatedFramesAreIgnored) {
+    transaction();
+    uint8_t master_frame[SPLIT_MASTER_FRAME_MAX];
+    split_master_set_backlight(&master, 1);
+    split_master_build_frame(&master, master_frame);
+    EXPECT_TRUE(split_slave_receive_frame(&slave, master_frame));
+    EXPECT_TRUE(slave.backlight_updated);
+    slave.backlight_updated = false;
+    EXPECT_TRUE(split_slave_receive_frame(&slave, master_frame));
+    EXPECT_FALSE(slave.backlight_updated);
+}
+
+TEST_F(SplitProtocol, TruncatedFramesAreRejected) {
+    build_slave_frame();
+    slave_frame[0] = 2;
+    EXPECT_FALSE(split_master_receive_frame(&master, slave_frame, now));
+    slave_frame[0] = SPLIT_SLAVE_FRAME_MAX + 1;
+    EXPECT_FALSE(split_master_receive_frame(&master, slave_frame, now));
+}
+
+TEST_F(SplitProtocol, ResyncAfterDisconnect) {
+    rows[0] = 0x01;
+    transaction();
+    transaction();
+    split_master_resync(&master);
+    EXPECT_FALSE(rows_match());
+    for (int i = 0; i < 3; i++) {
+        transaction();
+    }
+    EXPECT_TRUE(rows_match());
+}
+
+// Compares the time on the wire with the legacy link, which sends all the
+// rows and a checksum every transaction at 24us per bit
+TEST_F(SplitProtocol, BenchmarkLinkTime) {
+    const uint32_t legacy_bytes = SPLIT_ROWS_PER_HAND + 1 + 1 + 1;
+    const uint32_t legacy_us = wire_time_us(legacy_bytes, LEGACY_BIT_US);
+
+    transaction();
+    transaction();
+    transaction();
+    uint32_t idle_us = wire_time_us(slave_bytes + master_bytes, FRAMED_BIT_US);
+
+    rows[1] = 0x08;
+    transaction();
+    uint32_t keypress_us = wire_time_us(slave_bytes + master_bytes, FRAMED_BIT_US);
+
+    split_master_set_rgblight(&master, 0xAABBCCDD);
+    split_master_set_backlight(&master, 2);
+    transaction();
+    uint32_t rgb_us = wire_time_us(slave_bytes + master_bytes, FRAMED_BIT_US);
+
+    int recovery = 0;
+    rows[0] = 0x40;
+    corrupt_slave_frame = true;
+    transaction();
+    while (!rows_match() && recovery < 10) {
+        transaction();
+        recovery++;
+    }
+
+    printf("[ BENCHMARK] legacy:   %4u us per transaction, no RGB sync\n", legacy_us);
+    printf("[ BENCHMARK] framed:   %4u us idle, %4u us on a keypress, %4u us on an RGB change\n",
+        idle_us, keypress_us, rgb_us);
+    printf("[ BENCHMARK] recovery: %d transactions after a corrupt frame\n", recovery);
+    EXPECT_LT(idle_us, legacy_us);
+    EXPECT_LE(recovery, 3);
+}
@@ -0,0 +1,47 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Included before quantum/matrix.c, in place of avr/io.h and the keyboard
+ * config. The io registers are kept by the test, which works out the state
+ * of the PINx registers from the keys that are held.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+uint8_t *matrix_test_io(uint8_t addr);
+#ifdef __cplusplus
+}
+#endif
+
+#define _SFR_IO8(addr) (*matrix_test_io(addr))
+#define _BV(bit) (1 << (bit))
+
+#define COL2ROW 0
+#define ROW2COL 1
+#define DIODE_DIRECTION COL2ROW
+
+// The pins are encoded like in config_common.h, PINx address << 4 | bit
+// D4-D7
+#define MATRIX_ROW_PINS { 0x94, 0x95, 0x96, 0x97 }
+// F0 F1 F4 F5 F6 F7 B1 B3 B2 B6 B5 B4 E6 D0 D1 D2 D3 C6 C7 B0
+#define MATRIX_COL_PINS { 0xF0, 0xF1, 0xF4, 0xF5, 0xF6, 0xF7, 0x31, 0x33, 0x32, 0x36, \
+                          0x35, 0x34, 0xC6, 0x90, 0x91, 0x92, 0x93, 0x66, 0x67, 0x30 }
+#define MATRIX_TEST_PORTS 5
@@ -0,0 +1,183 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <string.h>
+extern "C" {
+#include "matrix.h"
+}
+
+namespace {
+    const uint8_t row_pins[MATRIX_ROWS] = MATRIX_ROW_PINS;
+    const uint8_t col_pins[MATRIX_COLS] = MATRIX_COL_PINS;
+
+    // The io registers, PINx at the address of the port, DDRx and PORTx after it
+    uint8_t io[0x40];
+    bool keys[MATRIX_ROWS][MATRIX_COLS];
+    // How many times each PINx register has been read
+    uint32_t pin_reads[0x40];
+    // Reads a col stays low after its row is unselected, like a slow pull-up
+    uint32_t recharge_reads;
+    uint32_t col_low_reads[MATRIX_COLS];
+    bool row_was_selected[MATRIX_ROWS];
+
+    bool row_selected(uint8_t row) {
+        uint8_t pin = row_pins[row];
+        uint8_t bit = _BV(pin & 0xF);
+        return (io[(pin >> 4) + 1] & bit) && !(io[(pin >> 4) + 2] & bit);
+    }
+
+    bool col_pulled_low(uint8_t col) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            if (keys[row][col] && row_selected(row)) {
+                return true;
+            }
+        }
+        if (col_low_reads[col] > 0) {
+            col_low_reads[col]--;
+            return true;
+        }
+        return false;
+    }
+
+    void update_pins(uint8_t addr) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            bool selected = row_selected(row);
+            if (row_was_selected[row] && !selected) {
+                for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                    if (keys[row][col]) {
+                        col_low_reads[col] = recharge_reads;
+                    }
+                }
+            }
+            row_was_selected[row] = selected;
+        }
+
+        uint8_t ddr = io[addr + 1];
+        uint8_t port = io[addr + 2];
+        // Outputs read back what they drive, inputs are high when pulled up
+        uint8_t pins = port;
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            uint8_t pin = col_pins[col];
+            uint8_t bit = _BV(pin & 0xF);
+            if ((pin >> 4) == addr && !(ddr & bit) && col_pulled_low(col)) {
+                pins &= ~bit;
+            }
+        }
+        io[addr] = pins;
+        pin_reads[addr]++;
+    }
+
+    uint32_t total_pin_reads(void) {
+        uint32_t total = 0;
+        for (uint8_t addr = 0; addr < sizeof(pin_reads) / sizeof(pin_reads[0]); addr++) {
+            total += pin_reads[addr];
+        }
+        return total;
+    }
+}
+
+extern "C" uint8_t *matrix_test_io(uint8_t addr) {
+    // The registers of a port are PINx, DDRx and PORTx, from B at 0x03
+    if (addr % 3 == 0) {
+        update_pins(addr);
+    }
+    return &io[addr];
+}
+
+class Matrix : public ::testing::Test {
+protected:
+    void SetUp() override {
+        memset(io, 0, sizeof(io));
+        memset(keys, 0, sizeof(keys));
+        memset(col_low_reads, 0, sizeof(col_low_reads));
+        memset(row_was_selected, 0, sizeof(row_was_selected));
+        recharge_reads = 0;
+        matrix_init();
+        memset(pin_reads, 0, sizeof(pin_reads));
+    }
+};
+
+TEST_F(Matrix, NoKeys) {
+    matrix_scan();
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        EXPECT_EQ(matrix_get_row(row), 0u);
+    }
+}
+
+TEST_F(Matrix, ColsOnEveryPort) {
+    keys[0][0] = true;   // F0
+    keys[0][7] = true;   // B3, after F on another port
+    keys[1][12] = true;  // E6, alone on its port
+    keys[2][16] = true;  // D3, on the port of the rows
+    keys[3][19] = true;  // B0, after the other B pins
+    keys[3][6] = true;   // B1
+    matrix_scan();
+    EXPECT_EQ(matrix_get_row(0), (1ul << 0) | (1ul << 7));
+    EXPECT_EQ(matrix_get_row(1), 1ul << 12);
+    EXPECT_EQ(matrix_get_row(2), 1ul << 16);
+    EXPECT_EQ(matrix_get_row(3), (1ul << 19) | (1ul << 6));
+}
+
+TEST_F(Matrix, Release) {
+    keys[2][3] = true;
+    matrix_scan();
+    EXPECT_EQ(matrix_get_row(2), 1ul << 3);
+    keys[2][3] = false;
+    matrix_scan();
+    EXPECT_EQ(matrix_get_row(2), 0u);
+}
+
+TEST_F(Matrix, RowsAreUnselectedAfterTheScan) {
+    keys[1][1] = true;
+    matrix_scan();
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        EXPECT_FALSE(row_selected(row));
+    }
+}
+
+#ifndef MATRIX_IO_DELAY_ADAPTIVE
+TEST_F(Matrix, ReadsEachPortOncePerRow) {
+    keys[0][0] = true;
+    matrix_scan();
+    EXPECT_EQ(total_pin_reads(), MATRIX_TEST_PORTS * MATRIX_ROWS);
+    EXPECT_EQ(pin_reads[0x03], MATRIX_ROWS);
+    EXPECT_EQ(pin_reads[0x0F], MATRIX_ROWS);
+}
+#else
+TEST_F(Matrix, WaitsForTheColsToRecharge) {
+    recharge_reads = 3;
+    keys[0][5] = true;
+    matrix_scan();
+    EXPECT_EQ(matrix_get_row(0), 1ul << 5);
+    // Without the wait, the next row sees a key that isn't there
+    EXPECT_EQ(matrix_get_row(1), 0u);
+}
+
+TEST_F(Matrix, DoesntWaitWhenTheColsAreHigh) {
+    matrix_scan();
+    // The row read, and one check that the cols are high
+    EXPECT_EQ(total_pin_reads(), 2 * MATRIX_TEST_PORTS * MATRIX_ROWS);
+}
+
+TEST_F(Matrix, WaitIsBounded) {
+    recharge_reads = 1000000;
+    keys[0][5] = true;
+    matrix_scan();
+    // The F port is checked at most MATRIX_IO_DELAY times after each row
+    EXPECT_LE(pin_reads[0x0F], MATRIX_ROWS * (1 + MATRIX_IO_DELAY));
+}
+#endif
@@ -0,0 +1,15 @@
+MATRIX_COMMON_DEFS := -DMATRIX_ROWS=4 -DMATRIX_COLS=20 -DDEBOUNCING_DELAY=0 -DMATRIX_IO_DELAY=30 \
+	-DNO_PRINT -DNO_DEBUG -include $(QUANTUM_PATH)/tests/matrix_test_io.h
+
+MATRIX_COMMON_SRC := \
+	$(QUANTUM_PATH)/tests/matrix_tests.cpp \
+	$(QUANTUM_PATH)/matrix.c \
+	$(QUANTUM_PATH)/debounce/sym_g.c \
+	$(TMK_PATH)/common/util.c \
+	$(TMK_PATH)/common/test/timer.c
+
+matrix_col2row_DEFS := $(MATRIX_COMMON_DEFS)
+matrix_col2row_SRC := $(MATRIX_COMMON_SRC)
+
+matrix_col2row_adaptive_DEFS := $(MATRIX_COMMON_DEFS) -DMATRIX_IO_DELAY_ADAPTIVE
+matrix_col2row_adaptive_SRC := $(MATRIX_COMMON_SRC)
@@ -0,0 +1,3 @@
+TEST_LIST +=\
+	matrix_col2row\
+	matrix_col2row_adaptive
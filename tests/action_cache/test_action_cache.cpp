@@ -0,0 +1,125 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <chrono>
+
+extern "C" {
+extern uint16_t dynamic_keycode;
+}
+
+using testing::_;
+
+class ActionCache : public TestFixture {
+public:
+    ~ActionCache() {
+        keymap_config.raw = 0;
+        dynamic_keycode = KC_B;
+        action_cache_clear();
+    }
+
+    void tap_key(TestDriver& driver, uint8_t col, uint8_t row, uint8_t code) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(code)));
+        press_key(col, row);
+        run_one_scan_loop();
+        testing::Mock::VerifyAndClearExpectations(&driver);
+
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+        release_key(col, row);
+        run_one_scan_loop();
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+
+    // the layer keys only send empty reports
+    void hold_layer_key(TestDriver& driver, uint8_t col, uint8_t row) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(testing::AnyNumber());
+        press_key(col, row);
+        run_one_scan_loop();
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+
+    void release_layer_key(TestDriver& driver, uint8_t col, uint8_t row) {
+        EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(testing::AnyNumber());
+        release_key(col, row);
+        run_one_scan_loop();
+        testing::Mock::VerifyAndClearExpectations(&driver);
+    }
+};
+
+TEST_F(ActionCache, CachedKeysSendTheSameReports) {
+    TestDriver driver;
+    tap_key(driver, 1, 0, KC_A);
+    tap_key(driver, 1, 0, KC_A);
+    tap_key(driver, 0, 0, KC_LALT);
+}
+
+TEST_F(ActionCache, TheKeycodeSwapsApplyToCachedKeys) {
+    TestDriver driver;
+    tap_key(driver, 0, 0, KC_LALT);
+    keymap_config.swap_lalt_lgui = true;
+    tap_key(driver, 0, 0, KC_LGUI);
+    keymap_config.swap_lalt_lgui = false;
+    tap_key(driver, 0, 0, KC_LALT);
+}
+
+TEST_F(ActionCache, LayersAboveTheCacheAreLookedUpToo) {
+    TestDriver driver;
+    hold_layer_key(driver, 2, 0);
+    tap_key(driver, 1, 0, KC_1);
+    release_layer_key(driver, 2, 0);
+
+    hold_layer_key(driver, 3, 0);
+    tap_key(driver, 1, 0, KC_X);
+    release_layer_key(driver, 3, 0);
+
+    tap_key(driver, 1, 0, KC_A);
+}
+
+TEST_F(ActionCache, ChangedKeycodesNeedTheCacheCleared) {
+    TestDriver driver;
+    tap_key(driver, 4, 0, KC_B);
+    dynamic_keycode = KC_C;
+    tap_key(driver, 4, 0, KC_B);
+    action_cache_clear();
+    tap_key(driver, 4, 0, KC_C);
+}
+
+TEST_F(ActionCache, LookupBenchmark) {
+    TestDriver driver;
+    const int rounds = 20000;
+    uint32_t sum = 0;
+    auto lookup_all = [&](bool cached) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            for (uint8_t layer = 0; layer < 2; layer++) {
+                for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+                    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                        keypos_t key = {.col = col, .row = row};
+                        action_t action = cached ? action_for_key(layer, key)
+                            : action_for_keycode(keymap_key_to_keycode(layer, key));
+                        sum += action.code;
+                    }
+                }
+            }
+        }
+        std::chrono::nanoseconds total = std::chrono::steady_clock::now() - start;
+        return static_cast<double>(total.count()) / (rounds * 2 * MATRIX_ROWS * MATRIX_COLS);
+    };
+    double decoded = lookup_all(false);
+    double cached = lookup_all(true);
+    EXPECT_NE(sum, 0);
+    printf("[ BENCHMARK] action lookup: %5.1f ns decoded, %5.1f ns cached\n", decoded, cached);
+}
@@ -18,6 +18,7 @@
 
 using testing::_;
 using testing::Return;
+using testing::AnyNumber;
 
 class ActionLayer : public TestFixture {};
 
@@ -90,3 +91,55 @@ TEST_F(ActionLayer, LayerStateCmp) {
 //     layer_off(2);
 //     EXPECT_EQ(layer_state, 0b1000);
 // }
+
+TEST_F(ActionLayer, LayerSwitchGetLayerFollowsLayerChanges) {
+    TestDriver driver;
+    // Changing layers clears the keyboard
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    keypos_t mapped_key = {.col = 0, .row = 0};
+    keypos_t transparent_key = {.col = 1, .row = 0};
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 0);
+    layer_on(1);
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 1);
+    EXPECT_EQ(layer_switch_get_layer(transparent_key), 0);
+    layer_off(1);
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 0);
+    // Some keymaps assign the layer state directly
+    layer_state = 1UL << 1;
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 1);
+    layer_state = 0;
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 0);
+}
+
+TEST_F(ActionLayer, KeyOnHigherLayerIsReported) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    layer_on(1);
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    run_one_scan_loop();
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(ActionLayer, LayerChangeInProcessRecordDoesNotChangeTheAction) {
+    TestDriver driver;
+    press_key(1, 1);
+    // Turning on layer 1 clears the keyboard first
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_F)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_TRUE(layer_state_is(1));
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    layer_off(1);
+    release_key(1, 1);
+    run_one_scan_loop();
+}
@@ -0,0 +1,89 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <vector>
+
+extern "C" {
+#include "deferred.h"
+}
+
+using testing::_;
+using testing::ElementsAre;
+
+static std::vector<intptr_t> calls;
+
+static void record_call(void *arg) {
+    calls.push_back((intptr_t)arg);
+}
+
+class Deferred : public TestFixture {
+protected:
+    Deferred() {
+        calls.clear();
+    }
+};
+
+TEST_F(Deferred, CallbacksRunInDeadlineOrder) {
+    TestDriver driver;
+    deferred_add(30, record_call, (void*)3);
+    deferred_add(10, record_call, (void*)1);
+    deferred_add(20, record_call, (void*)2);
+    idle_for(10);
+    EXPECT_TRUE(calls.empty());
+    run_one_scan_loop();
+    EXPECT_THAT(calls, ElementsAre(1));
+    idle_for(20);
+    EXPECT_THAT(calls, ElementsAre(1, 2, 3));
+}
+
+TEST_F(Deferred, ACancelledCallbackDoesNotRun) {
+    TestDriver driver;
+    deferred_token_t token = deferred_add(10, record_call, (void*)1);
+    deferred_add(10, record_call, (void*)2);
+    EXPECT_TRUE(deferred_cancel(token));
+    EXPECT_FALSE(deferred_cancel(token));
+    idle_for(11);
+    EXPECT_THAT(calls, ElementsAre(2));
+}
+
+TEST_F(Deferred, TimeLeftIsUntilTheEarliestDeadline) {
+    TestDriver driver;
+    uint16_t time_left;
+    EXPECT_FALSE(deferred_time_left(&time_left));
+    deferred_token_t token = deferred_add(50, record_call, (void*)1);
+    deferred_add(20, record_call, (void*)2);
+    EXPECT_TRUE(deferred_time_left(&time_left));
+    EXPECT_EQ(time_left, 20);
+    idle_for(21);
+    EXPECT_TRUE(deferred_time_left(&time_left));
+    EXPECT_EQ(time_left, 29);
+    deferred_cancel(token);
+    EXPECT_FALSE(deferred_time_left(&time_left));
+}
+
+TEST_F(Deferred, AddingFailsWhenAllSlotsAreInUse) {
+    TestDriver driver;
+    std::vector<deferred_token_t> tokens;
+    for (int i = 0; i < DEFERRED_MAX; i++) {
+        tokens.push_back(deferred_add(100, record_call, nullptr));
+        EXPECT_NE(tokens.back(), DEFERRED_TOKEN_NONE);
+    }
+    EXPECT_EQ(deferred_add(100, record_call, nullptr), DEFERRED_TOKEN_NONE);
+    for (auto token : tokens) {
+        deferred_cancel(token);
+    }
+}
@@ -0,0 +1,56 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+
+// The same scripted rolls are run by the batch_scan test, which processes
+// every change of a scan at once, so the printed numbers can be compared.
+class ScanLatency : public TestFixture {};
+
+TEST_F(ScanLatency, FourKeyRollTakesOneScanPerKey) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(4);
+    press_key(0, 0);
+    press_key(1, 0);
+    press_key(0, 3);
+    press_key(1, 3);
+    unsigned scans = scans_until_report(KeyboardReport(KC_A, KC_B, KC_C, KC_D), 10);
+    printf("[ LATENCY  ] per-key: 4 key press roll took %u scans\n", scans);
+    EXPECT_EQ(scans, 4);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(4);
+    clear_all_keys();
+    scans = scans_until_report(KeyboardReport(), 10);
+    printf("[ LATENCY  ] per-key: 4 key release roll took %u scans\n", scans);
+    EXPECT_EQ(scans, 4);
+}
+
+TEST_F(ScanLatency, OverlappingRollTakesOneScanPerChange) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(0, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    press_key(1, 0);
+    press_key(0, 3);
+    unsigned scans = scans_until_report(KeyboardReport(KC_B, KC_C), 10);
+    printf("[ LATENCY  ] per-key: overlapping roll took %u scans\n", scans);
+    EXPECT_EQ(scans, 3);
+}
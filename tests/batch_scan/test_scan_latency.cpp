@@ -0,0 +1,104 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::InSequence;
+
+// These are the same scripted rolls as in the basic test, which processes
+// one key per scan, so the printed numbers can be compared.
+class ScanLatency : public TestFixture {};
+
+TEST_F(ScanLatency, FourKeyRollTakesOneScan) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_B, KC_C, KC_D)));
+    press_key(0, 0);
+    press_key(1, 0);
+    press_key(0, 3);
+    press_key(1, 3);
+    unsigned scans = scans_until_report(KeyboardReport(KC_A, KC_B, KC_C, KC_D), 10);
+    printf("[ LATENCY  ] batched: 4 key press roll took %u scans\n", scans);
+    EXPECT_EQ(scans, 1);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    clear_all_keys();
+    scans = scans_until_report(KeyboardReport(), 10);
+    printf("[ LATENCY  ] batched: 4 key release roll took %u scans\n", scans);
+    EXPECT_EQ(scans, 1);
+}
+
+TEST_F(ScanLatency, OverlappingRollTakesOneScan) {
+    TestDriver driver;
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    press_key(0, 0);
+    run_one_scan_loop();
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B, KC_C)));
+    release_key(0, 0);
+    press_key(1, 0);
+    press_key(0, 3);
+    unsigned scans = scans_until_report(KeyboardReport(KC_B, KC_C), 10);
+    printf("[ LATENCY  ] batched: overlapping roll took %u scans\n", scans);
+    EXPECT_EQ(scans, 1);
+}
+
+TEST_F(ScanLatency, ModifierAndKeyInTheSameScanAreSentTogether) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A, KC_LSFT)));
+    press_key(0, 0);
+    press_key(3, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(ScanLatency, TapInsideABatchIsNotLost) {
+    TestDriver driver;
+    InSequence s;
+    press_key(7, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The mod tap key is released in the same scan as a later key in the
+    // matrix is pressed, the tap still has to reach the host before that key.
+    release_key(7, 0);
+    press_key(0, 3);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_P)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
+    run_one_scan_loop();
+}
+
+TEST_F(ScanLatency, ReleaseAndPressAgainInsideABatchIsNotLost) {
+    TestDriver driver;
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    press_key(0, 0);
+    run_one_scan_loop();
+
+    // The report ends up the same as the one sent, but the host still has
+    // to see A go up and down.
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    press_key(8, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(0, 0);
+    release_key(8, 0);
+    run_one_scan_loop();
+}
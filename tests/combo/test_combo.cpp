@@ -0,0 +1,123 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::AtLeast;
+using testing::InSequence;
+
+extern "C" {
+    extern uint16_t last_combo_event;
+    extern bool last_combo_event_pressed;
+    void use_bef_for_first_combo(bool use);
+}
+
+class Combo : public TestFixture {};
+
+TEST_F(Combo, PressingAllKeysOfAComboSendsItsKeycode) {
+    TestDriver driver;
+    InSequence s;
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, TappingAComboKeySendsTheKey) {
+    TestDriver driver;
+    InSequence s;
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).Times(AtLeast(1));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, HoldingAComboKeyPastTheTermSendsTheKey) {
+    TestDriver driver;
+    InSequence s;
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(COMBO_TERM);
+    // The key is unregistered before it's registered
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A))).Times(AtLeast(1));
+    idle_for(10);
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, CombosOutsideTheIndexAreStillRecognized) {
+    TestDriver driver;
+    InSequence s;
+    press_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Y)));
+    run_one_scan_loop();
+    release_key(2, 0);
+    release_key(3, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, ComboActionsCallProcessComboEvent) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(4, 0);
+    run_one_scan_loop();
+    press_key(5, 0);
+    run_one_scan_loop();
+    EXPECT_EQ(last_combo_event, 2);
+    EXPECT_TRUE(last_combo_event_pressed);
+    release_key(4, 0);
+    run_one_scan_loop();
+    EXPECT_FALSE(last_combo_event_pressed);
+    release_key(5, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(Combo, ChangingTheKeysOfAComboAtRuntime) {
+    TestDriver driver;
+    InSequence s;
+    use_bef_for_first_combo(true);
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    press_key(4, 0);
+    run_one_scan_loop();
+    press_key(5, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    run_one_scan_loop();
+    release_key(1, 0);
+    release_key(4, 0);
+    release_key(5, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    run_one_scan_loop();
+    use_bef_for_first_combo(false);
+}
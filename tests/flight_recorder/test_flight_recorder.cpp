@@ -0,0 +1,235 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "flight_replay.hpp"
+#include "action_tapping.h"
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "flight_recorder.h"
+}
+
+using testing::_;
+using testing::InSequence;
+using testing::Invoke;
+
+static std::string dump_text;
+
+static int8_t dump_char(uint8_t c) {
+    dump_text += static_cast<char>(c);
+    return 0;
+}
+
+class FlightRecorder : public TestFixture {
+public:
+    FlightRecorder() {
+        flight_recorder_clear();
+    }
+
+    static std::string dump() {
+        dump_text.clear();
+        flight_recorder_dump(dump_char);
+        return dump_text;
+    }
+
+    static std::vector<FlightEvent> recorded() {
+        std::vector<FlightEvent> events;
+        for (uint8_t i = 0; i < flight_recorder_count(); i++) {
+            flight_record_t record = flight_recorder_get(i);
+            events.push_back(FlightEvent{record.time, record.key.row, record.key.col, record.pressed, record.layer_state});
+        }
+        return events;
+    }
+
+    // A mod tap roll, and a layer key held over two keys
+    void play_session() {
+        press_key(3, 0);
+        idle_for(20);
+        press_key(1, 0);
+        idle_for(15);
+        release_key(3, 0);
+        idle_for(10);
+        release_key(1, 0);
+        idle_for(50);
+        press_key(0, 0);
+        idle_for(30);
+        press_key(1, 0);
+        idle_for(25);
+        release_key(1, 0);
+        run_one_scan_loop();
+        press_key(2, 0);
+        idle_for(40);
+        release_key(0, 0);
+        release_key(2, 0);
+        idle_for(TAPPING_TERM);
+    }
+};
+
+TEST_F(FlightRecorder, RecordsEventsWithTheirLayerState) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    press_key(0, 0);
+    run_one_scan_loop();
+    uint16_t press_time = timer_read();
+    idle_for(9);
+    press_key(1, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+
+    ASSERT_EQ(flight_recorder_count(), 4);
+    flight_record_t layer_press = flight_recorder_get(0);
+    EXPECT_EQ(layer_press.key.row, 0);
+    EXPECT_EQ(layer_press.key.col, 0);
+    EXPECT_TRUE(layer_press.pressed);
+    EXPECT_EQ(layer_press.layer_state, 0);
+    flight_record_t key_press = flight_recorder_get(1);
+    EXPECT_EQ(key_press.key.col, 1);
+    EXPECT_TRUE(key_press.pressed);
+    EXPECT_EQ(key_press.layer_state, 1 << 1);
+    EXPECT_EQ(static_cast<uint16_t>(key_press.time - layer_press.time), 10);
+    EXPECT_EQ(layer_press.time, press_time - 1 | 1);
+    EXPECT_FALSE(flight_recorder_get(3).pressed);
+}
+
+TEST_F(FlightRecorder, KeepsTheNewestEventsWhenFull) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    for (int i = 0; i < FLIGHT_RECORDER_SIZE; i++) {
+        press_key(1 + i % 2, 0);
+        run_one_scan_loop();
+        release_key(1 + i % 2, 0);
+        run_one_scan_loop();
+    }
+    ASSERT_EQ(flight_recorder_count(), FLIGHT_RECORDER_SIZE);
+    // The first half of the presses and releases were overwritten
+    flight_record_t oldest = flight_recorder_get(0);
+    EXPECT_EQ(oldest.key.col, 1 + (FLIGHT_RECORDER_SIZE / 2) % 2);
+    EXPECT_TRUE(oldest.pressed);
+    flight_record_t newest = flight_recorder_get(FLIGHT_RECORDER_SIZE - 1);
+    EXPECT_EQ(newest.key.col, 1 + (FLIGHT_RECORDER_SIZE - 1) % 2);
+    EXPECT_FALSE(newest.pressed);
+}
+
+TEST_F(FlightRecorder, DumpFormat) {
+    flight_recorder_record((keyevent_t){ .key = { .col = 3, .row = 1 }, .pressed = true, .time = 0x1235 });
+    flight_recorder_record((keyevent_t){ .key = { .col = 3, .row = 1 }, .pressed = false, .time = 0x12a1 });
+    EXPECT_EQ(dump(),
+        "FLIGHT 1 02\n"
+        "E 1235 01 03 1 00000000\n"
+        "E 12a1 01 03 0 00000000\n"
+        "END\n");
+}
+
+TEST_F(FlightRecorder, LoadSkipsOtherConsoleOutput) {
+    std::istringstream input(
+        "debug: on\n"
+        "FLIGHT 1 01\n"
+        "E 0001 00 02 1 00000002\n"
+        "END\n"
+        "C> \n");
+    FlightReplay replay;
+    ASSERT_TRUE(replay.load(input));
+    ASSERT_EQ(replay.events().size(), 1);
+    EXPECT_EQ(replay.events()[0].col, 2);
+    EXPECT_EQ(replay.events()[0].layer_state, 2);
+
+    std::istringstream truncated(
+        "FLIGHT 1 02\n"
+        "E 0001 00 02 1 00000002\n"
+        "END\n");
+    EXPECT_FALSE(replay.load(truncated));
+}
+
+TEST_F(FlightRecorder, ReplaySendsTheSameReports) {
+    TestDriver driver;
+    std::vector<report_keyboard_t> reports;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(Invoke([&reports](report_keyboard_t& report) {
+        reports.push_back(report);
+    }));
+    play_session();
+    std::vector<FlightEvent> original = recorded();
+    std::vector<report_keyboard_t> original_reports = reports;
+    std::istringstream input(dump());
+
+    flight_recorder_clear();
+    reports.clear();
+    idle_for(1000);
+    FlightReplay replay;
+    ASSERT_TRUE(replay.load(input));
+    replay.replay(TAPPING_TERM);
+
+    ASSERT_EQ(reports.size(), original_reports.size());
+    for (size_t i = 0; i < reports.size(); i++) {
+        EXPECT_TRUE(reports[i] == original_reports[i]) << "report " << i;
+    }
+    std::vector<FlightEvent> replayed = recorded();
+    ASSERT_EQ(replayed.size(), original.size());
+    for (size_t i = 0; i < replayed.size(); i++) {
+        EXPECT_EQ(replayed[i].row, original[i].row);
+        EXPECT_EQ(replayed[i].col, original[i].col);
+        EXPECT_EQ(replayed[i].pressed, original[i].pressed);
+        EXPECT_EQ(replayed[i].layer_state, original[i].layer_state);
+        EXPECT_EQ(static_cast<uint16_t>(replayed[i].time - replayed[0].time),
+            static_cast<uint16_t>(original[i].time - original[0].time));
+    }
+}
+
+// A recorded typing burst with rolls, mod taps and a layer key, replayed as a
+// regression and performance corpus
+TEST_F(FlightRecorder, ReplaysTheTypingBurstCorpus) {
+    TestDriver driver;
+    std::vector<report_keyboard_t> reports;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(Invoke([&reports](report_keyboard_t& report) {
+        reports.push_back(report);
+    }));
+    FlightReplay replay;
+    ASSERT_TRUE(replay.load_file("tests/flight_recorder/typing_burst.flight"));
+    const std::vector<FlightEvent>& events = replay.events();
+    ASSERT_EQ(events.size(), 72);
+
+    auto start = std::chrono::steady_clock::now();
+    unsigned scans = replay.replay(TAPPING_TERM);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    std::vector<report_keyboard_t> first_reports = reports;
+    EXPECT_EQ(first_reports.size(), 75);
+
+    // The layer states seen while replaying are the ones that were recorded
+    std::vector<FlightEvent> replayed = recorded();
+    ASSERT_EQ(replayed.size(), FLIGHT_RECORDER_SIZE);
+    for (size_t i = 0; i < replayed.size(); i++) {
+        const FlightEvent& original = events[events.size() - FLIGHT_RECORDER_SIZE + i];
+        EXPECT_EQ(replayed[i].col, original.col);
+        EXPECT_EQ(replayed[i].pressed, original.pressed);
+        EXPECT_EQ(replayed[i].layer_state, original.layer_state);
+    }
+
+    reports.clear();
+    idle_for(1000);
+    replay.replay(TAPPING_TERM);
+    ASSERT_EQ(reports.size(), first_reports.size());
+    for (size_t i = 0; i < reports.size(); i++) {
+        EXPECT_TRUE(reports[i] == first_reports[i]) << "report " << i;
+    }
+    printf("[ BENCHMARK] %zu events, %u scans, %lld ns per scan\n", events.size(), scans,
+        static_cast<long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() / scans));
+}
@@ -0,0 +1,97 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+
+using testing::_;
+using testing::AnyNumber;
+
+extern "C" uint16_t dynamic_keycode;
+
+class LayerCache : public TestFixture {
+public:
+    void SetUp() override {
+        dynamic_keycode = KC_TRNS;
+        layer_cache_invalidate();
+    }
+};
+
+TEST_F(LayerCache, FollowsLayerChanges) {
+    TestDriver driver;
+    // Changing layers clears the keyboard
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    keypos_t mapped_key = {.col = 0, .row = 0};
+    keypos_t transparent_key = {.col = 1, .row = 0};
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 0);
+    layer_on(1);
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 1);
+    EXPECT_EQ(layer_switch_get_layer(transparent_key), 0);
+    layer_off(1);
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 0);
+    // Some keymaps assign the layer state directly
+    layer_state = 1UL << 1;
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 1);
+    layer_state = 0;
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 0);
+}
+
+TEST_F(LayerCache, KeyOnHigherLayerIsReported) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    layer_on(1);
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E)));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+    press_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B)));
+    run_one_scan_loop();
+    release_key(1, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(LayerCache, KeymapChangesNeedAnInvalidate) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    keypos_t key = {.col = 2, .row = 0};
+    layer_on(1);
+    EXPECT_EQ(layer_switch_get_layer(key), 0);
+    // The cache still has the layer it resolved before the keymap changed
+    dynamic_keycode = KC_X;
+    EXPECT_EQ(layer_switch_get_layer(key), 0);
+    layer_cache_invalidate();
+    EXPECT_EQ(layer_switch_get_layer(key), 1);
+    layer_off(1);
+}
+
+TEST_F(LayerCache, KeysOutsideTheMatrixAreNotCached) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    keypos_t row_outside = {.col = 0, .row = MATRIX_ROWS};
+    keypos_t col_outside = {.col = MATRIX_COLS, .row = MATRIX_ROWS - 1};
+    EXPECT_EQ(layer_switch_get_layer(row_outside), 0);
+    EXPECT_EQ(layer_switch_get_layer(col_outside), 0);
+    layer_on(1);
+    EXPECT_EQ(layer_switch_get_layer(row_outside), 1);
+    EXPECT_EQ(layer_switch_get_layer(col_outside), 1);
+    layer_off(1);
+    // The keys inside the matrix are still cached as before
+    keypos_t mapped_key = {.col = 0, .row = 0};
+    EXPECT_EQ(layer_switch_get_layer(mapped_key), 0);
+}
@@ -0,0 +1,47 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        // 0     1      2      3      4      5      6      7      8      9
+        {KC_LEAD, KC_A, KC_B,  KC_C,  KC_D,  KC_E,  KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,  KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,  KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+        {KC_NO,  KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO, KC_NO},
+    },
+};
+
+const uint16_t PROGMEM a_seq[] = {KC_A, KC_NO};
+const uint16_t PROGMEM ab_seq[] = {KC_A, KC_B, KC_NO};
+const uint16_t PROGMEM bc_seq[] = {KC_B, KC_C, KC_NO};
+const uint16_t PROGMEM ccccccc_seq[] = {KC_C, KC_C, KC_C, KC_C, KC_C, KC_C, KC_C, KC_NO};
+const uint16_t PROGMEM d_seq[] = {KC_D, KC_NO};
+
+const leader_seq_t PROGMEM leader_sequences[LEADER_SEQUENCE_COUNT] = {
+    LEADER_SEQ(a_seq, KC_X),
+    LEADER_SEQ(ab_seq, KC_Y),
+    LEADER_SEQ_ACTION(bc_seq),
+    LEADER_SEQ(ccccccc_seq, KC_Z),
+    LEADER_SEQ(d_seq, KC_W),
+};
+
+uint16_t last_leader_event = 0xFFFF;
+
+void process_leader_event(uint16_t seq_index) {
+    last_leader_event = seq_index;
+}
@@ -0,0 +1,133 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "deferred.h"
+#include <vector>
+
+using testing::_;
+using testing::AnyNumber;
+using testing::AtLeast;
+using testing::InSequence;
+
+extern "C" {
+    extern bool leading;
+    extern uint16_t last_leader_event;
+}
+
+class Leader : public TestFixture {
+protected:
+    void tap_key(uint8_t col) {
+        press_key(col, 0);
+        run_one_scan_loop();
+        release_key(col, 0);
+        run_one_scan_loop();
+    }
+};
+
+TEST_F(Leader, TheSequencesAreSorted) {
+    EXPECT_TRUE(leader_sequences_sorted());
+}
+
+TEST_F(Leader, AUniqueSequenceIsTriggeredWithoutWaitingForTheTimeout) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    last_leader_event = 0xFFFF;
+    tap_key(0);
+    EXPECT_TRUE(leading);
+    tap_key(2);
+    EXPECT_EQ(last_leader_event, 0xFFFF);
+    tap_key(3);
+    EXPECT_EQ(last_leader_event, 2);
+    EXPECT_FALSE(leading);
+}
+
+TEST_F(Leader, ASequenceThatIsAPrefixOfAnotherIsTriggeredAfterTheTimeout) {
+    TestDriver driver;
+    InSequence s;
+    tap_key(0);
+    // Only the presses are consumed, releasing them sends empty reports
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(1);
+    idle_for(LEADER_TIMEOUT - 10);
+    EXPECT_TRUE(leading);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(20);
+    EXPECT_FALSE(leading);
+}
+
+static void do_nothing(void *arg) {}
+
+TEST_F(Leader, ASequenceTimesOutWhenTheKeymapUsesAllSlots) {
+    TestDriver driver;
+    InSequence s;
+    std::vector<deferred_token_t> tokens;
+    for (int i = 0; i < DEFERRED_MAX; i++) {
+        tokens.push_back(deferred_add(1000, do_nothing, nullptr));
+    }
+    EXPECT_EQ(deferred_add(1000, do_nothing, nullptr), DEFERRED_TOKEN_NONE);
+    tap_key(0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_X)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    idle_for(LEADER_TIMEOUT + 10);
+    EXPECT_FALSE(leading);
+    for (auto token : tokens) {
+        deferred_cancel(token);
+    }
+}
+
+TEST_F(Leader, ContinuingPastAPrefixTriggersTheLongerSequence) {
+    TestDriver driver;
+    InSequence s;
+    tap_key(0);
+    tap_key(1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Y)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    tap_key(2);
+    EXPECT_FALSE(leading);
+}
+
+TEST_F(Leader, SequencesCanBeLongerThanFiveKeys) {
+    TestDriver driver;
+    InSequence s;
+    tap_key(0);
+    // Only the presses are consumed, releasing them sends empty reports
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    for (int i = 0; i < 6; i++) {
+        tap_key(3);
+    }
+    EXPECT_TRUE(leading);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_Z)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    tap_key(3);
+    EXPECT_FALSE(leading);
+}
+
+TEST_F(Leader, AnUnknownSequenceEndsLeadingImmediately) {
+    TestDriver driver;
+    InSequence s;
+    tap_key(0);
+    // Only the presses are consumed, releasing them sends empty reports
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(5);
+    EXPECT_FALSE(leading);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_E)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    tap_key(5);
+}
@@ -0,0 +1,144 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "flight_replay.hpp"
+#include "action_tapping.h"
+#include <string>
+
+extern "C" {
+#include "perf_stats.h"
+}
+
+using testing::_;
+
+static std::string dump_text;
+
+static int8_t dump_char(uint8_t c) {
+    dump_text += static_cast<char>(c);
+    return 0;
+}
+
+// The test timer only moves a millisecond per scan, so everything that
+// happens within a scan takes no time, and the latencies are whole scans.
+class PerfStats : public TestFixture {
+public:
+    PerfStats() {
+        perf_stats_clear();
+    }
+};
+
+TEST_F(PerfStats, CountsTheScansPerSecond) {
+    TestDriver driver;
+    EXPECT_EQ(perf_stats_scan_rate(), 0);
+    idle_for(1001);
+    EXPECT_EQ(perf_stats_scan_rate(), 1000);
+    const perf_stat_t *scan = perf_stats_get(PERF_MATRIX_SCAN);
+    EXPECT_EQ(scan->count, 1001);
+    EXPECT_EQ(scan->max, 0);
+    EXPECT_EQ(scan->histogram[0], 1001);
+}
+
+TEST_F(PerfStats, MeasuresTheLatencyFromTheScanToTheReport) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    press_key(1, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(1, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // The tap of a mod tap key is only sent when it's released
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(2);
+    press_key(3, 0);
+    idle_for(49);
+    release_key(3, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    const perf_stat_t *latency = perf_stats_get(PERF_SCAN_TO_REPORT);
+    EXPECT_EQ(latency->count, 3);
+    EXPECT_EQ(latency->min, 0);
+    EXPECT_EQ(latency->max, 49000);
+    EXPECT_EQ(latency->total, 49000);
+    // 49000 has 16 bits, which goes in the last bucket
+    EXPECT_EQ(latency->histogram[0], 2);
+    EXPECT_EQ(latency->histogram[PERF_HISTOGRAM_SIZE - 1], 1);
+    EXPECT_EQ(perf_stats_get(PERF_REPORT_SEND)->count, 4);
+    EXPECT_EQ(perf_stats_get(PERF_PROCESS_RECORD)->count, 4);
+}
+
+TEST_F(PerfStats, KeysWithoutReportsCountTowardsTheNextReport) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    press_key(5, 0);
+    idle_for(10);
+    release_key(5, 0);
+    idle_for(10);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    press_key(1, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_EQ(perf_stats_get(PERF_SCAN_TO_REPORT)->count, 1);
+    EXPECT_EQ(perf_stats_get(PERF_SCAN_TO_REPORT)->max, 20000);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(1, 0);
+    run_one_scan_loop();
+}
+
+TEST_F(PerfStats, DumpFormat) {
+    dump_text.clear();
+    perf_stats_dump(dump_char);
+    std::string zeros = " 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0\n";
+    EXPECT_EQ(dump_text,
+        "STATS 1 0\n"
+        "matrix_scan" + zeros +
+        "process_record" + zeros +
+        "lighting" + zeros +
+        "report_send" + zeros +
+        "scan_to_report" + zeros +
+        "END\n");
+
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(2);
+    press_key(3, 0);
+    idle_for(20);
+    release_key(3, 0);
+    run_one_scan_loop();
+    dump_text.clear();
+    perf_stats_dump(dump_char);
+    EXPECT_NE(dump_text.find("scan_to_report 1 20000 20000 20000 0 0 0 0 0 0 0 0 0 0 0 0 0 0 0 1\n"), std::string::npos) << dump_text;
+}
+
+// Tracks the latencies of the typing burst recorded by the flight recorder test
+TEST_F(PerfStats, TypingBurstLatency) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(testing::AnyNumber());
+    FlightReplay replay;
+    ASSERT_TRUE(replay.load_file("tests/flight_recorder/typing_burst.flight"));
+    replay.replay(TAPPING_TERM);
+
+    const perf_stat_t *latency = perf_stats_get(PERF_SCAN_TO_REPORT);
+    printf("[ LATENCY  ] typing burst: %u reports, scan to report min %u avg %u max %u us\n",
+        latency->count, latency->min, latency->count ? latency->total / latency->count : 0, latency->max);
+    EXPECT_EQ(latency->count, 56);
+}
@@ -0,0 +1,171 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using testing::_;
+using testing::InSequence;
+using testing::Invoke;
+
+class ReportQueue : public TestFixture {};
+
+TEST_F(ReportQueue, FirstReportOfAFrameIsSentRightAway) {
+    TestDriver driver;
+    // Start in a frame of its own, keyboard_init() sent a report in the first one
+    run_one_scan_loop();
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    keyboard_task();
+}
+
+TEST_F(ReportQueue, DuplicateReportsAreDropped) {
+    TestDriver driver;
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    send_keyboard_report();
+    send_keyboard_report();
+    run_one_scan_loop();
+    send_keyboard_report();
+    run_one_scan_loop();
+}
+
+TEST_F(ReportQueue, ChangesWithinAFrameAreMerged) {
+    TestDriver driver;
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    register_code(KC_LSFT);
+    register_code(KC_A);
+    register_code(KC_B);
+    // The frame of the reports above lasts until the end of this scan
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_A, KC_B)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    unregister_code(KC_A);
+    unregister_code(KC_B);
+    unregister_code(KC_LSFT);
+}
+
+TEST_F(ReportQueue, PressAndReleaseWithinAFrameAreBothSent) {
+    TestDriver driver;
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    register_code(KC_LSFT);
+    register_code(KC_A);
+    unregister_code(KC_A);
+    register_code(KC_A);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // One report per frame
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_A)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_LSFT, KC_A)));
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    unregister_code(KC_A);
+    unregister_code(KC_LSFT);
+}
+
+TEST_F(ReportQueue, IdleMouseReportsAreDropped) {
+    TestDriver driver;
+    report_mouse_t report = {};
+    EXPECT_CALL(driver, send_mouse_mock(_));
+    host_mouse_send(&report);
+    host_mouse_send(&report);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    report.x = 1;
+    EXPECT_CALL(driver, send_mouse_mock(_)).Times(2);
+    host_mouse_send(&report);
+    host_mouse_send(&report);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    report.x = 0;
+    report.buttons = MOUSE_BTN1;
+    EXPECT_CALL(driver, send_mouse_mock(_)).Times(2);
+    host_mouse_send(&report);
+    host_mouse_send(&report);
+    report.buttons = 0;
+    host_mouse_send(&report);
+}
+
+// Types the keys that each report presses, the way the host would see them
+static std::string type_reports(const std::vector<report_keyboard_t>& reports) {
+    std::string typed;
+    report_keyboard_t previous = {};
+    for (const report_keyboard_t& report : reports) {
+        bool shifted = report.mods & MOD_BIT(KC_LSFT);
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            uint8_t key = report.keys[i];
+            if (!key || std::find(previous.keys, previous.keys + KEYBOARD_REPORT_KEYS, key) != previous.keys + KEYBOARD_REPORT_KEYS) {
+                continue;
+            }
+            if (key >= KC_A && key <= KC_Z) {
+                typed += (shifted ? 'A' : 'a') + (key - KC_A);
+            } else if (key == KC_1 && shifted) {
+                typed += '!';
+            } else if (key == KC_COMM) {
+                typed += ',';
+            } else if (key == KC_SPC) {
+                typed += ' ';
+            } else {
+                typed += '?';
+            }
+        }
+        previous = report;
+    }
+    return typed;
+}
+
+TEST_F(ReportQueue, MacroBurstSendsFewerReports) {
+    TestDriver driver;
+    std::vector<report_keyboard_t> reports;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).WillRepeatedly(Invoke([&reports](report_keyboard_t& report) {
+        reports.push_back(report);
+    }));
+    press_key(4, 0);
+    idle_for(20);
+    release_key(4, 0);
+    run_one_scan_loop();
+
+    // Without the queue every press and release of the 13 characters is a
+    // report, and so are the shift presses and releases of H and W
+    const unsigned unqueued = 13 * 2 + 2 * 2;
+    printf("[ REPORTS  ] \"Hello, World!\" sent %u reports, %u without the queue\n", (unsigned)reports.size(), unqueued);
+    EXPECT_EQ(type_reports(reports), "Hello, World!");
+    report_keyboard_t released = {};
+    EXPECT_TRUE(reports.back() == released);
+    EXPECT_LT(reports.size(), unqueued);
+}
@@ -0,0 +1,35 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTS_RGB_MATRIX_CONFIG_H_
+#define TESTS_RGB_MATRIX_CONFIG_H_
+
+#define MATRIX_ROWS 6
+#define MATRIX_COLS 16
+
+#define DRIVER_ADDR_1 0b1110100
+#define DRIVER_ADDR_2 0b1110111
+#define DRIVER_COUNT 2
+#define DRIVER_1_LED_TOTAL 48
+// Two extra LEDs, a second one under a key and one that is not under any key
+#define DRIVER_2_LED_TOTAL 50
+#define DRIVER_LED_TOTAL (DRIVER_1_LED_TOTAL + DRIVER_2_LED_TOTAL)
+
+#define RGB_MATRIX_KEYPRESSES
+#define RGB_MATRIX_TICK_MS 50
+#define RGB_MATRIX_LED_PROCESS_LIMIT 20
+
+#endif /* TESTS_RGB_MATRIX_CONFIG_H_ */
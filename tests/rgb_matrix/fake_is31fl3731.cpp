@@ -0,0 +1,68 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fake_is31fl3731.hpp"
+
+extern "C" {
+#include "is31fl3731.h"
+#include "i2c_master.h"
+}
+
+static RGB led_colors[DRIVER_LED_TOTAL];
+static unsigned flush_count = 0;
+
+RGB fake_is31fl3731_get_color(int index) {
+    return led_colors[index];
+}
+
+unsigned fake_is31fl3731_get_flush_count() {
+    return flush_count;
+}
+
+extern "C" {
+
+void i2c_init(void) {
+}
+
+void IS31FL3731_init(uint8_t addr) {
+}
+
+void IS31FL3731_set_color(int index, uint8_t red, uint8_t green, uint8_t blue) {
+    if (index >= 0 && index < DRIVER_LED_TOTAL) {
+        led_colors[index] = { .r = red, .g = green, .b = blue };
+    }
+}
+
+void IS31FL3731_set_color_all(uint8_t red, uint8_t green, uint8_t blue) {
+    for (int i = 0; i < DRIVER_LED_TOTAL; i++) {
+        IS31FL3731_set_color(i, red, green, blue);
+    }
+}
+
+void IS31FL3731_set_led_control_register(uint8_t index, bool red, bool green, bool blue) {
+}
+
+void IS31FL3731_update_pwm_buffer(uint8_t addr, uint8_t index) {
+}
+
+void IS31FL3731_update_pwm_buffers(uint8_t addr1, uint8_t addr2) {
+}
+
+void IS31FL3731_update_led_control_registers(uint8_t addr1, uint8_t addr2) {
+    flush_count++;
+}
+
+}
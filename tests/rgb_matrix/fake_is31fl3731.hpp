@@ -0,0 +1,33 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TESTS_RGB_MATRIX_FAKE_IS31FL3731_H_
+#define TESTS_RGB_MATRIX_FAKE_IS31FL3731_H_
+
+#include <stdint.h>
+
+extern "C" {
+#include "color.h"
+}
+
+// Replaces the IS31FL3731 driver, the colors are just stored per LED
+// so that the tests can check what the effects rendered
+RGB fake_is31fl3731_get_color(int index);
+// The number of frames flushed to the driver, the LED control registers
+// are written last at the end of every frame
+unsigned fake_is31fl3731_get_flush_count();
+
+#endif /* TESTS_RGB_MATRIX_FAKE_IS31FL3731_H_ */
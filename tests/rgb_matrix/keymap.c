@@ -0,0 +1,130 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quantum.h"
+
+const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
+    [0] = {
+        {KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M, KC_N, KC_O, KC_P},
+        {KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z, KC_A, KC_B, KC_C, KC_D, KC_E, KC_F},
+        {KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M, KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V},
+        {KC_W, KC_X, KC_Y, KC_Z, KC_A, KC_B, KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L},
+        {KC_M, KC_N, KC_O, KC_P, KC_Q, KC_R, KC_S, KC_T, KC_U, KC_V, KC_W, KC_X, KC_Y, KC_Z, KC_A, KC_B},
+        {KC_C, KC_D, KC_E, KC_F, KC_G, KC_H, KC_I, KC_J, KC_K, KC_L, KC_M, KC_N, KC_O, KC_P, KC_Q, KC_R},
+    },
+};
+
+// A 6x16 grid spread over the whole 224x64 effect area, one LED per key
+const rgb_led g_rgb_leds[DRIVER_LED_TOTAL] = {
+    {{ 0 | (0 << 4) }, { 0, 0 }, 0},
+    {{ 0 | (1 << 4) }, { 14, 0 }, 0},
+    {{ 0 | (2 << 4) }, { 29, 0 }, 0},
+    {{ 0 | (3 << 4) }, { 44, 0 }, 0},
+    {{ 0 | (4 << 4) }, { 59, 0 }, 0},
+    {{ 0 | (5 << 4) }, { 74, 0 }, 0},
+    {{ 0 | (6 << 4) }, { 89, 0 }, 0},
+    {{ 0 | (7 << 4) }, { 104, 0 }, 0},
+    {{ 0 | (8 << 4) }, { 119, 0 }, 0},
+    {{ 0 | (9 << 4) }, { 134, 0 }, 0},
+    {{ 0 | (10 << 4) }, { 149, 0 }, 0},
+    {{ 0 | (11 << 4) }, { 164, 0 }, 0},
+    {{ 0 | (12 << 4) }, { 179, 0 }, 0},
+    {{ 0 | (13 << 4) }, { 194, 0 }, 0},
+    {{ 0 | (14 << 4) }, { 209, 0 }, 0},
+    {{ 0 | (15 << 4) }, { 224, 0 }, 0},
+    {{ 1 | (0 << 4) }, { 0, 12 }, 0},
+    {{ 1 | (1 << 4) }, { 14, 12 }, 0},
+    {{ 1 | (2 << 4) }, { 29, 12 }, 0},
+    {{ 1 | (3 << 4) }, { 44, 12 }, 0},
+    {{ 1 | (4 << 4) }, { 59, 12 }, 0},
+    {{ 1 | (5 << 4) }, { 74, 12 }, 0},
+    {{ 1 | (6 << 4) }, { 89, 12 }, 0},
+    {{ 1 | (7 << 4) }, { 104, 12 }, 0},
+    {{ 1 | (8 << 4) }, { 119, 12 }, 0},
+    {{ 1 | (9 << 4) }, { 134, 12 }, 0},
+    {{ 1 | (10 << 4) }, { 149, 12 }, 0},
+    {{ 1 | (11 << 4) }, { 164, 12 }, 0},
+    {{ 1 | (12 << 4) }, { 179, 12 }, 0},
+    {{ 1 | (13 << 4) }, { 194, 12 }, 0},
+    {{ 1 | (14 << 4) }, { 209, 12 }, 0},
+    {{ 1 | (15 << 4) }, { 224, 12 }, 0},
+    {{ 2 | (0 << 4) }, { 0, 25 }, 0},
+    {{ 2 | (1 << 4) }, { 14, 25 }, 0},
+    {{ 2 | (2 << 4) }, { 29, 25 }, 0},
+    {{ 2 | (3 << 4) }, { 44, 25 }, 0},
+    {{ 2 | (4 << 4) }, { 59, 25 }, 0},
+    {{ 2 | (5 << 4) }, { 74, 25 }, 0},
+    {{ 2 | (6 << 4) }, { 89, 25 }, 0},
+    {{ 2 | (7 << 4) }, { 104, 25 }, 0},
+    {{ 2 | (8 << 4) }, { 119, 25 }, 0},
+    {{ 2 | (9 << 4) }, { 134, 25 }, 0},
+    {{ 2 | (10 << 4) }, { 149, 25 }, 0},
+    {{ 2 | (11 << 4) }, { 164, 25 }, 0},
+    {{ 2 | (12 << 4) }, { 179, 25 }, 0},
+    {{ 2 | (13 << 4) }, { 194, 25 }, 0},
+    {{ 2 | (14 << 4) }, { 209, 25 }, 0},
+    {{ 2 | (15 << 4) }, { 224, 25 }, 0},
+    {{ 3 | (0 << 4) }, { 0, 38 }, 0},
+    {{ 3 | (1 << 4) }, { 14, 38 }, 0},
+    {{ 3 | (2 << 4) }, { 29, 38 }, 0},
+    {{ 3 | (3 << 4) }, { 44, 38 }, 0},
+    {{ 3 | (4 << 4) }, { 59, 38 }, 0},
+    {{ 3 | (5 << 4) }, { 74, 38 }, 0},
+    {{ 3 | (6 << 4) }, { 89, 38 }, 0},
+    {{ 3 | (7 << 4) }, { 104, 38 }, 0},
+    {{ 3 | (8 << 4) }, { 119, 38 }, 0},
+    {{ 3 | (9 << 4) }, { 134, 38 }, 0},
+    {{ 3 | (10 << 4) }, { 149, 38 }, 0},
+    {{ 3 | (11 << 4) }, { 164, 38 }, 0},
+    {{ 3 | (12 << 4) }, { 179, 38 }, 0},
+    {{ 3 | (13 << 4) }, { 194, 38 }, 0},
+    {{ 3 | (14 << 4) }, { 209, 38 }, 0},
+    {{ 3 | (15 << 4) }, { 224, 38 }, 0},
+    {{ 4 | (0 << 4) }, { 0, 51 }, 0},
+    {{ 4 | (1 << 4) }, { 14, 51 }, 0},
+    {{ 4 | (2 << 4) }, { 29, 51 }, 0},
+    {{ 4 | (3 << 4) }, { 44, 51 }, 0},
+    {{ 4 | (4 << 4) }, { 59, 51 }, 0},
+    {{ 4 | (5 << 4) }, { 74, 51 }, 0},
+    {{ 4 | (6 << 4) }, { 89, 51 }, 0},
+    {{ 4 | (7 << 4) }, { 104, 51 }, 0},
+    {{ 4 | (8 << 4) }, { 119, 51 }, 0},
+    {{ 4 | (9 << 4) }, { 134, 51 }, 0},
+    {{ 4 | (10 << 4) }, { 149, 51 }, 0},
+    {{ 4 | (11 << 4) }, { 164, 51 }, 0},
+    {{ 4 | (12 << 4) }, { 179, 51 }, 0},
+    {{ 4 | (13 << 4) }, { 194, 51 }, 0},
+    {{ 4 | (14 << 4) }, { 209, 51 }, 0},
+    {{ 4 | (15 << 4) }, { 224, 51 }, 0},
+    {{ 5 | (0 << 4) }, { 0, 64 }, 0},
+    {{ 5 | (1 << 4) }, { 14, 64 }, 0},
+    {{ 5 | (2 << 4) }, { 29, 64 }, 0},
+    {{ 5 | (3 << 4) }, { 44, 64 }, 0},
+    {{ 5 | (4 << 4) }, { 59, 64 }, 0},
+    {{ 5 | (5 << 4) }, { 74, 64 }, 0},
+    {{ 5 | (6 << 4) }, { 89, 64 }, 0},
+    {{ 5 | (7 << 4) }, { 104, 64 }, 0},
+    {{ 5 | (8 << 4) }, { 119, 64 }, 0},
+    {{ 5 | (9 << 4) }, { 134, 64 }, 0},
+    {{ 5 | (10 << 4) }, { 149, 64 }, 0},
+    {{ 5 | (11 << 4) }, { 164, 64 }, 0},
+    {{ 5 | (12 << 4) }, { 179, 64 }, 0},
+    {{ 5 | (13 << 4) }, { 194, 64 }, 0},
+    {{ 5 | (14 << 4) }, { 209, 64 }, 0},
+    {{ 5 | (15 << 4) }, { 224, 64 }, 0},
+    {{ 2 | (5 << 4) }, { 74, 25 }, 0},
+    {{ 15 | (15 << 4) }, { 112, 32 }, 0},
+};
@@ -0,0 +1,194 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "fake_is31fl3731.hpp"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+extern "C" {
+    extern rgb_config_t rgb_matrix_config;
+    void advance_time(uint32_t ms);
+}
+
+class RgbMatrix : public TestFixture {
+public:
+    RgbMatrix() {
+        rgb_matrix_config.enable = 1;
+        rgb_matrix_config.mode = RGB_MATRIX_SOLID_COLOR;
+        rgb_matrix_config.hue = 0;
+        rgb_matrix_config.sat = 255;
+        rgb_matrix_config.val = 255;
+        rgb_matrix_config.speed = 0;
+        // Skip the startup delay
+        advance_time(1000);
+        render_frame();
+    }
+
+    // Runs the rgb matrix task until a whole frame has been rendered and flushed,
+    // returns the number of calls that took
+    static int render_frame() {
+        advance_time(RGB_MATRIX_TICK_MS);
+        unsigned flush_count = fake_is31fl3731_get_flush_count();
+        int calls = 0;
+        while (fake_is31fl3731_get_flush_count() == flush_count && calls < 1000) {
+            rgb_matrix_task();
+            calls++;
+        }
+        return calls;
+    }
+
+    void hit_key(uint8_t row, uint8_t col) {
+        keyrecord_t record = {};
+        record.event.key.row = row;
+        record.event.key.col = col;
+        record.event.pressed = true;
+        process_rgb_matrix(KC_A, &record);
+    }
+
+    static int brightness(int index) {
+        RGB rgb = fake_is31fl3731_get_color(index);
+        return rgb.r + rgb.g + rgb.b;
+    }
+};
+
+TEST_F(RgbMatrix, SinAndCosMatchFloatingPoint) {
+    for (int angle = 0; angle < 256; angle++) {
+        double radians = angle * M_PI / 128;
+        EXPECT_NEAR(rgb_matrix_sin(angle), 255 * std::sin(radians), 1.0) << "angle " << angle;
+        EXPECT_NEAR(rgb_matrix_cos(angle), 255 * std::cos(radians), 1.0) << "angle " << angle;
+    }
+}
+
+TEST_F(RgbMatrix, DistanceMatchesTruncatedSqrt) {
+    for (int x = 0; x < 256; x++) {
+        for (int y = 0; y < 256; y++) {
+            uint16_t expected = (uint16_t)std::sqrt((double)(x * x + y * y));
+            ASSERT_EQ(rgb_matrix_distance({0, 0}, {(uint8_t)x, (uint8_t)y}), expected) << x << ", " << y;
+            ASSERT_EQ(rgb_matrix_distance({(uint8_t)x, (uint8_t)y}, {0, 0}), expected) << x << ", " << y;
+        }
+    }
+}
+
+TEST_F(RgbMatrix, KeysMapToTheirLeds) {
+    uint8_t leds[8];
+    uint8_t led_count;
+    map_row_column_to_led(0, 0, leds, &led_count);
+    ASSERT_EQ(led_count, 1);
+    EXPECT_EQ(leds[0], 0);
+    map_row_column_to_led(5, 15, leds, &led_count);
+    ASSERT_EQ(led_count, 1);
+    EXPECT_EQ(leds[0], 95);
+}
+
+TEST_F(RgbMatrix, KeysCanHaveSeveralLeds) {
+    uint8_t leds[8];
+    uint8_t led_count;
+    map_row_column_to_led(2, 5, leds, &led_count);
+    ASSERT_EQ(led_count, 2);
+    EXPECT_EQ(leds[0], 37);
+    EXPECT_EQ(leds[1], 96);
+}
+
+TEST_F(RgbMatrix, LedsOutsideOfTheMatrixAreNotMapped) {
+    uint8_t leds[8];
+    uint8_t led_count = 1;
+    map_row_column_to_led(15, 15, leds, &led_count);
+    EXPECT_EQ(led_count, 0);
+}
+
+TEST_F(RgbMatrix, FramesAreRenderedAndFlushedInParts) {
+    const int parts = (DRIVER_LED_TOTAL + RGB_MATRIX_LED_PROCESS_LIMIT - 1) / RGB_MATRIX_LED_PROCESS_LIMIT;
+    rgb_matrix_config.val = 0;
+    render_frame();
+    EXPECT_EQ(brightness(0), 0);
+    rgb_matrix_config.val = 255;
+    advance_time(RGB_MATRIX_TICK_MS);
+    rgb_matrix_task();
+    EXPECT_GT(brightness(0), 0);
+    EXPECT_GT(brightness(RGB_MATRIX_LED_PROCESS_LIMIT - 1), 0);
+    EXPECT_EQ(brightness(RGB_MATRIX_LED_PROCESS_LIMIT), 0);
+    EXPECT_EQ(brightness(DRIVER_LED_TOTAL - 1), 0);
+    // The rest of the parts, and one call per driver flush
+    for (int i = 1; i < parts + 2; i++) {
+        rgb_matrix_task();
+    }
+    EXPECT_GT(brightness(DRIVER_LED_TOTAL - 1), 0);
+}
+
+TEST_F(RgbMatrix, NewFramesWaitForTheNextTick) {
+    render_frame();
+    unsigned flush_count = fake_is31fl3731_get_flush_count();
+    for (int i = 0; i < 100; i++) {
+        rgb_matrix_task();
+    }
+    EXPECT_EQ(fake_is31fl3731_get_flush_count(), flush_count);
+}
+
+TEST_F(RgbMatrix, AnimationsFollowTheElapsedTime) {
+    uint32_t tick = rgb_matrix_get_tick();
+    render_frame();
+    EXPECT_EQ(rgb_matrix_get_tick(), tick + 1);
+    // A slow frame skips the ticks it missed instead of slowing down
+    advance_time(RGB_MATRIX_TICK_MS * 2);
+    render_frame();
+    EXPECT_EQ(rgb_matrix_get_tick(), tick + 4);
+}
+
+TEST_F(RgbMatrix, SolidSplashStartsAtTheHitKey) {
+    TestDriver driver;
+    rgb_matrix_config.mode = RGB_MATRIX_SOLID_SPLASH;
+    // Row 2, column 5 is LED 37, the bottom right corner is LED 95
+    hit_key(2, 5);
+    for (int i = 0; i < 5; i++) {
+        render_frame();
+    }
+    EXPECT_GT(brightness(37), brightness(95));
+    EXPECT_EQ(brightness(95), 0);
+}
+
+TEST_F(RgbMatrix, BenchmarkEffects) {
+    TestDriver driver;
+    const int frames = 200;
+    const int rounds = 10;
+    for (uint8_t effect = RGB_MATRIX_SOLID_COLOR; effect < RGB_MATRIX_EFFECT_MAX; effect++) {
+        rgb_matrix_config.mode = effect;
+        std::chrono::nanoseconds total(0);
+        long calls = 0;
+        for (int round = 0; round < rounds; round++) {
+            // Keep the maximum number of key hits alive, so that the
+            // splash effects do their worst case amount of work
+            for (uint8_t hit = 0; hit < 8; hit++) {
+                hit_key(hit % MATRIX_ROWS, hit * 2);
+            }
+            for (int frame = 0; frame < frames; frame++) {
+                advance_time(RGB_MATRIX_TICK_MS);
+                unsigned flush_count = fake_is31fl3731_get_flush_count();
+                auto start = std::chrono::steady_clock::now();
+                while (fake_is31fl3731_get_flush_count() == flush_count) {
+                    rgb_matrix_task();
+                    calls++;
+                }
+                total += std::chrono::steady_clock::now() - start;
+            }
+        }
+        // The frame is spread over several scans, each one only pays for its part
+        printf("[ BENCHMARK] effect %2d: %8.0f ns/frame, %6.0f ns/scan for %d LEDs\n",
+            effect, (double)total.count() / (frames * rounds), (double)total.count() / calls, DRIVER_LED_TOTAL);
+    }
+}
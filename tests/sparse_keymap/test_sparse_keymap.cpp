@@ -0,0 +1,117 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include <chrono>
+
+extern "C" {
+#include "keymap_sparse.h"
+#include "util.h"
+}
+
+using testing::_;
+
+// the keymap has 4 layers
+static const uint8_t layers = 4;
+
+class SparseKeymap : public TestFixture {
+};
+
+TEST_F(SparseKeymap, HasAllTheLayers) {
+    EXPECT_EQ(keymap_sparse_size, layers * MATRIX_ROWS * MATRIX_COLS);
+}
+
+TEST_F(SparseKeymap, HasTheKeycodesOfTheDenseKeymap) {
+    for (uint8_t layer = 0; layer < layers; layer++) {
+        for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+            for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                keypos_t key = {.col = col, .row = row};
+                uint16_t keycode = pgm_read_word(&keymaps[layer][row][col]);
+                EXPECT_EQ(keymap_key_to_keycode(layer, key), keycode);
+            }
+        }
+    }
+}
+
+TEST_F(SparseKeymap, LayersPastTheEndAreTransparent) {
+    keypos_t key = {.col = 1, .row = 0};
+    EXPECT_EQ(keymap_key_to_keycode(layers, key), KC_TRNS);
+}
+
+TEST_F(SparseKeymap, KeysFallThroughTheTransparentLayers) {
+    TestDriver driver;
+    // the layer keys only send empty reports
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(testing::AnyNumber());
+    press_key(9, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_RGHT)));
+    press_key(9, 2);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // layer 3 is transparent there
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_RGHT, KC_A)));
+    press_key(1, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_RGHT)));
+    release_key(1, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(9, 2);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(testing::AnyNumber());
+    release_key(9, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+}
+
+TEST_F(SparseKeymap, LookupBenchmark) {
+    const int rounds = 20000;
+    uint32_t sum = 0;
+    auto lookup_all = [&](bool sparse) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            for (uint8_t layer = 0; layer < layers; layer++) {
+                for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+                    for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+                        keypos_t key = {.col = col, .row = row};
+                        sum += sparse ? keymap_key_to_keycode(layer, key)
+                            : pgm_read_word(&keymaps[layer][row][col]);
+                    }
+                }
+            }
+        }
+        std::chrono::nanoseconds total = std::chrono::steady_clock::now() - start;
+        return static_cast<double>(total.count()) / (rounds * layers * MATRIX_ROWS * MATRIX_COLS);
+    };
+    double dense = lookup_all(false);
+    double sparse = lookup_all(true);
+    EXPECT_NE(sum, 0);
+
+    uint16_t words = (keymap_sparse_size + 15) / 16;
+    uint16_t stored = keymap_sparse_rank[words - 1] + bitpop16(keymap_sparse_bitmap[words - 1]);
+    size_t sparse_bytes = sizeof(keymap_sparse_size) + words * 4 + stored * 2;
+    printf("[ BENCHMARK] keymap: %zu bytes, %5.1f ns dense, %zu bytes, %5.1f ns sparse\n",
+        layers * sizeof(keymaps[0]), dense, sparse_bytes, sparse);
+}
@@ -0,0 +1,124 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "action_tapping.h"
+#include <vector>
+
+extern "C" {
+#include "deferred.h"
+}
+
+using testing::_;
+using testing::AnyNumber;
+using testing::AtLeast;
+using testing::InSequence;
+
+extern "C" {
+    uint16_t timer_read(void);
+}
+
+class TapDance : public TestFixture {
+protected:
+    void tap_key(uint8_t col) {
+        press_key(col, 0);
+        run_one_scan_loop();
+        release_key(col, 0);
+        run_one_scan_loop();
+    }
+};
+
+TEST_F(TapDance, ThereIsNoDeadlineWithoutADance) {
+    uint16_t deadline;
+    EXPECT_FALSE(tap_dance_next_deadline(&deadline));
+}
+
+TEST_F(TapDance, ASingleTapIsSentWhenTheTappingTermHasElapsed) {
+    TestDriver driver;
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(0);
+    uint16_t deadline;
+    EXPECT_TRUE(tap_dance_next_deadline(&deadline));
+    EXPECT_EQ(deadline, (uint16_t)(timer_read() - 2 + TAPPING_TERM + 1));
+    idle_for(TAPPING_TERM - 1);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    run_one_scan_loop();
+    EXPECT_FALSE(tap_dance_next_deadline(&deadline));
+}
+
+static void do_nothing(void *arg) {}
+
+TEST_F(TapDance, TheDanceTimesOutWhenTheKeymapUsesAllSlots) {
+    TestDriver driver;
+    InSequence s;
+    std::vector<deferred_token_t> tokens;
+    for (int i = 0; i < DEFERRED_MAX; i++) {
+        tokens.push_back(deferred_add(1000, do_nothing, nullptr));
+    }
+    EXPECT_EQ(deferred_add(1000, do_nothing, nullptr), DEFERRED_TOKEN_NONE);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    idle_for(TAPPING_TERM);
+    for (auto token : tokens) {
+        deferred_cancel(token);
+    }
+}
+
+TEST_F(TapDance, ADoubleTapFinishesImmediately) {
+    TestDriver driver;
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(0);
+    press_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_B))).Times(AtLeast(1));
+    run_one_scan_loop();
+    release_key(0, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    run_one_scan_loop();
+    uint16_t deadline;
+    EXPECT_FALSE(tap_dance_next_deadline(&deadline));
+}
+
+TEST_F(TapDance, AnotherKeyInterruptsTheDance) {
+    TestDriver driver;
+    InSequence s;
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AnyNumber());
+    tap_key(0);
+    press_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_A)));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport())).Times(AtLeast(1));
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_C)));
+    run_one_scan_loop();
+    release_key(2, 0);
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    run_one_scan_loop();
+}
+
+TEST_F(TapDance, TheDeadlineUsesTheCustomTappingTerm) {
+    TestDriver driver;
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    uint16_t start = timer_read();
+    tap_key(1);
+    uint16_t deadline;
+    EXPECT_TRUE(tap_dance_next_deadline(&deadline));
+    EXPECT_EQ(deadline, (uint16_t)(start + 100 + 1));
+    idle_for(100);
+    EXPECT_FALSE(tap_dance_next_deadline(&deadline));
+}
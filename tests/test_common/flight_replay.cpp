@@ -0,0 +1,103 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "flight_replay.hpp"
+#include <fstream>
+#include <sstream>
+#include "test_matrix.h"
+
+extern "C" {
+#include "keyboard.h"
+#include "timer.h"
+    void advance_time(uint32_t ms);
+}
+
+bool FlightReplay::load(std::istream& input) {
+    m_events.clear();
+    std::string line;
+    unsigned count = 0;
+    bool started = false;
+    while (std::getline(input, line)) {
+        std::istringstream fields(line);
+        std::string tag;
+        fields >> tag;
+        if (tag == "FLIGHT") {
+            unsigned version;
+            fields >> std::hex >> version >> count;
+            if (!fields || version != 1) {
+                return false;
+            }
+            started = true;
+            m_events.clear();
+        } else if (started && tag == "E") {
+            unsigned time, row, col, pressed;
+            uint32_t layer_state;
+            fields >> std::hex >> time >> row >> col >> pressed >> layer_state;
+            if (!fields) {
+                return false;
+            }
+            m_events.push_back(FlightEvent{
+                static_cast<uint16_t>(time),
+                static_cast<uint8_t>(row),
+                static_cast<uint8_t>(col),
+                pressed != 0,
+                layer_state
+            });
+        } else if (started && tag == "END") {
+            return m_events.size() == count;
+        }
+    }
+    return false;
+}
+
+bool FlightReplay::load_file(const std::string& path) {
+    std::ifstream input(path);
+    return input && load(input);
+}
+
+unsigned FlightReplay::replay(unsigned idle_after) {
+    unsigned scans = 0;
+    auto scan = [&scans]() {
+        keyboard_task();
+        advance_time(1);
+        scans++;
+    };
+    // Event times are odd, start at an even time so that they come out the
+    // same distance apart
+    if (timer_read32() & 1) {
+        scan();
+    }
+    uint32_t target = timer_read32();
+    for (size_t i = 0; i < m_events.size(); i++) {
+        const FlightEvent& event = m_events[i];
+        if (i > 0) {
+            target += static_cast<uint16_t>(event.time - m_events[i - 1].time);
+        }
+        while (static_cast<int32_t>(target - timer_read32()) > 0) {
+            scan();
+        }
+        if (event.pressed) {
+            press_key(event.col, event.row);
+        } else {
+            release_key(event.col, event.row);
+        }
+        scan();
+    }
+    for (unsigned i = 0; i < idle_after; i++) {
+        scan();
+    }
+    return scans;
+}
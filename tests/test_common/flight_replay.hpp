@@ -0,0 +1,49 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <istream>
+#include <string>
+#include <vector>
+
+// A key event from a flight recorder dump, see tmk_core/common/flight_recorder.h
+struct FlightEvent {
+    uint16_t time;
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+    uint32_t layer_state;
+};
+
+class FlightReplay {
+public:
+    // Reads a dump, skipping any other console output around it. Returns
+    // false when there is no complete dump.
+    bool load(std::istream& input);
+    bool load_file(const std::string& path);
+    const std::vector<FlightEvent>& events() const { return m_events; }
+
+    // Presses and releases the keys of the events in the test matrix, at the
+    // same times relative to each other, running keyboard_task() once per
+    // millisecond like TestFixture::run_one_scan_loop(). Every event gets a
+    // scan of its own, so that they are processed in the recorded order.
+    // Returns the number of scans.
+    unsigned replay(unsigned idle_after = 0);
+private:
+    std::vector<FlightEvent> m_events;
+};
@@ -58,15 +58,16 @@ std::ostream& operator<<(std::ostream& stream, const report_keyboard_t& value) {
 }
 
 KeyboardReportMatcher::KeyboardReportMatcher(const std::vector<uint8_t>& keys) {
-    memset(m_report.raw, 0, sizeof(m_report.raw));
+    report_builder_t builder = {};
     for (auto k: keys) {
         if (IS_MOD(k)) {
-            m_report.mods |= MOD_BIT(k);
+            builder.report.mods |= MOD_BIT(k);
         }
         else {
-            add_key_to_report(&m_report, k);
+            add_key_to_report(&builder, k);
         }
     }
+    m_report = builder.report;
 }
 
 bool KeyboardReportMatcher::MatchAndExplain(report_keyboard_t& report, MatchResultListener* listener) const {
@@ -0,0 +1,31 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The config shared by all the tests in tests/, included after the config.h
+ * of the test, which can override it.
+ */
+
+#ifndef TESTS_TEST_COMMON_TEST_CONFIG_H_
+#define TESTS_TEST_COMMON_TEST_CONFIG_H_
+
+#ifndef MATRIX_ROWS
+#define MATRIX_ROWS 4
+#endif
+#ifndef MATRIX_COLS
+#define MATRIX_COLS 10
+#endif
+
+#endif /* TESTS_TEST_COMMON_TEST_CONFIG_H_ */
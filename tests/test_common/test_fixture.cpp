@@ -5,6 +5,7 @@
 #include "keyboard.h"
 #include "action.h"
 #include "action_tapping.h"
+#include "action_util.h"
 
 extern "C" {
 #include "action_layer.h"
@@ -54,3 +55,13 @@ void TestFixture::idle_for(unsigned time) {
         run_one_scan_loop();
     }
 }
+
+unsigned TestFixture::scans_until_report(testing::Matcher<report_keyboard_t&> report, unsigned max_scans) {
+    for (unsigned i=1; i<=max_scans; i++) {
+        run_one_scan_loop();
+        if (report.Matches(*keyboard_report)) {
+            return i;
+        }
+    }
+    return max_scans + 1;
+}
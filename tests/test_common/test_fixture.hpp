@@ -17,6 +17,8 @@
  #pragma once
 
 #include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include "report.h"
 
 class TestFixture : public testing::Test {
 public:
@@ -27,4 +29,6 @@ public:
 
     void run_one_scan_loop();
     void idle_for(unsigned ms);
+    // Runs scan loops until the current keyboard report matches, and returns the number of loops needed
+    unsigned scans_until_report(testing::Matcher<report_keyboard_t&> report, unsigned max_scans);
 };
\ No newline at end of file
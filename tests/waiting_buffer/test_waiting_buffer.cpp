@@ -0,0 +1,66 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_common.hpp"
+#include "action_tapping.h"
+
+using testing::_;
+using testing::AnyNumber;
+using testing::InSequence;
+
+class WaitingBuffer : public TestFixture {};
+
+TEST_F(WaitingBuffer, HeldSecondTapAfterTheBufferFilledRepeats) {
+    TestDriver driver;
+    InSequence s;
+
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(AnyNumber());
+    press_key(0, 0);
+    run_one_scan_loop();
+    press_key(1, 0);
+    run_one_scan_loop();
+    press_key(2, 0);
+    run_one_scan_loop();
+    // The mods stay held while the tap key is undecided, their releases fill the buffer
+    press_key(3, 0);
+    run_one_scan_loop();
+    release_key(0, 0);
+    run_one_scan_loop();
+    release_key(1, 0);
+    run_one_scan_loop();
+    release_key(2, 0);
+    run_one_scan_loop();
+    // The first tap, its release doesn't fit into the buffer
+    release_key(3, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_EQ(waiting_buffer_peak(), WAITING_BUFFER_SIZE - 1);
+
+    // The second tap is still a tap, and is held as P instead of shift
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport(KC_P)));
+    press_key(3, 0);
+    run_one_scan_loop();
+    idle_for(TAPPING_TERM);
+    testing::Mock::VerifyAndClearExpectations(&driver);
+
+    // Nothing is left registered
+    EXPECT_CALL(driver, send_keyboard_mock(KeyboardReport()));
+    release_key(3, 0);
+    run_one_scan_loop();
+    testing::Mock::VerifyAndClearExpectations(&driver);
+    EXPECT_CALL(driver, send_keyboard_mock(_)).Times(0);
+    idle_for(TAPPING_TERM);
+}
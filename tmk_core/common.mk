@@ -35,7 +35,7 @@ ifeq ($(PLATFORM),CHIBIOS)
   endif
 endif
 
-ifeq ($(PLATFORM),TEST)
+ifneq ($(filter TEST SIM,$(PLATFORM)),)
 	TMK_COMMON_SRC += $(PLATFORM_COMMON_DIR)/eeprom.c
 endif
 
@@ -71,6 +71,25 @@ else
     TMK_COMMON_DEFS += -DNO_DEBUG
 endif
 
+ifeq ($(strip $(DEFERRED_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/deferred.c
+    TMK_COMMON_DEFS += -DDEFERRED_ENABLE
+endif
+
+ifeq ($(strip $(FLIGHT_RECORDER_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/flight_recorder.c
+    TMK_COMMON_DEFS += -DFLIGHT_RECORDER_ENABLE
+endif
+
+ifeq ($(strip $(PERF_STATS_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/perf_stats.c
+    TMK_COMMON_DEFS += -DPERF_STATS_ENABLE
+endif
+
+ifneq ($(filter yes,$(strip $(FLIGHT_RECORDER_ENABLE)) $(strip $(PERF_STATS_ENABLE))),)
+    TMK_COMMON_SRC += $(COMMON_DIR)/text_dump.c
+endif
+
 ifeq ($(strip $(COMMAND_ENABLE)), yes)
     TMK_COMMON_SRC += $(COMMON_DIR)/command.c
     TMK_COMMON_DEFS += -DCOMMAND_ENABLE
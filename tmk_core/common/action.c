@@ -26,7 +26,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "action_macro.h"
 #include "action_util.h"
 #include "action.h"
+#include "keymap.h"
 #include "wait.h"
+#include "perf_stats.h"
 
 #ifdef DEBUG_ACTION
 #include "debug.h"
@@ -44,6 +46,10 @@ int retro_tapping_counter = 0;
 #include <fauxclicky.h>
 #endif
 
+#ifdef FLIGHT_RECORDER_ENABLE
+#include "flight_recorder.h"
+#endif
+
 /** \brief Called to execute an action.
  *
  * FIXME: Needs documentation.
@@ -55,6 +61,9 @@ void action_exec(keyevent_t event)
         dprint("EVENT: "); debug_event(event); dprintln();
 #ifdef RETRO_TAPPING
         retro_tapping_counter++;
+#endif
+#ifdef FLIGHT_RECORDER_ENABLE
+        flight_recorder_record(event);
 #endif
     }
 
@@ -169,14 +178,22 @@ void process_record_tap_hint(keyrecord_t *record)
  *
  * FIXME: Needs documentation.
  */
-void process_record(keyrecord_t *record)
+static void process_record_handler(keyrecord_t *record)
 {
-    if (IS_NOEVENT(record->event)) { return; }
+    // Resolve the key only once, so that process_record_quantum() and the
+    // action always agree, even if the layer changes in between.
+    uint8_t layer = store_or_get_layer(record->event.pressed, record->event.key);
+    record->keycode = keymap_key_to_keycode(layer, record->event.key);
 
     if(!process_record_quantum(record))
         return;
 
-    action_t action = store_or_get_action(record->event.pressed, record->event.key);
+#ifdef ACTION_CACHE_LAYERS
+    // the same keycode, decoded already if it has been used before
+    action_t action = action_for_key(layer, record->event.key);
+#else
+    action_t action = action_for_keycode(record->keycode);
+#endif
     dprint("ACTION: "); debug_action(action);
 #ifndef NO_ACTION_LAYER
     dprint(" layer_state: "); layer_debug();
@@ -187,6 +204,13 @@ void process_record(keyrecord_t *record)
     process_action(record, action);
 }
 
+void process_record(keyrecord_t *record)
+{
+    if (IS_NOEVENT(record->event)) { return; }
+
+    PERF_MEASURE(PERF_PROCESS_RECORD, process_record_handler(record));
+}
+
 /** \brief Take an action and processes it.
  *
  * FIXME: Needs documentation.
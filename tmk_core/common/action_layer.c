@@ -1,4 +1,5 @@
 #include <stdint.h>
+#include <string.h>
 #include "keyboard.h"
 #include "action.h"
 #include "util.h"
@@ -262,10 +263,21 @@ uint8_t read_source_layers_cache(keypos_t key)
  * event as they may get stuck otherwise.
  */
 action_t store_or_get_action(bool pressed, keypos_t key)
+{
+    return action_for_key(store_or_get_layer(pressed, key), key);
+}
+
+/** \brief Store or get layer
+ *
+ * Returns the layer the key event should be resolved on, that is the
+ * current layer on press, and the layer the key was pressed on on release.
+ * See store_or_get_action().
+ */
+uint8_t store_or_get_layer(bool pressed, keypos_t key)
 {
 #if !defined(NO_ACTION_LAYER) && defined(PREVENT_STUCK_MODIFIERS)
     if (disable_action_cache) {
-        return layer_switch_get_action(key);
+        return layer_switch_get_layer(key);
     }
 
     uint8_t layer;
@@ -277,13 +289,31 @@ action_t store_or_get_action(bool pressed, keypos_t key)
     else {
         layer = read_source_layers_cache(key);
     }
-    return action_for_key(layer, key);
+    return layer;
 #else
-    return layer_switch_get_action(key);
+    return layer_switch_get_layer(key);
 #endif
 }
 
 
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_LOOKUP_CACHE)
+#define LAYER_CACHE_INVALID 0xFF
+/* zero initialised entries are valid, an empty layer state always resolves to layer 0 */
+static uint8_t layer_cache[MATRIX_ROWS][MATRIX_COLS];
+static uint32_t layer_cache_state = 0;
+
+/** \brief Layer cache invalidate
+ *
+ * Forgets all resolved layers. The cache is invalidated automatically when
+ * the layer state changes, this only needs to be called when the keymap
+ * itself is changed at runtime.
+ */
+void layer_cache_invalidate(void)
+{
+    memset(layer_cache, LAYER_CACHE_INVALID, sizeof(layer_cache));
+}
+#endif
+
 /** \brief Layer switch get layer
  *
  * FIXME: Needs docs
@@ -295,16 +325,37 @@ int8_t layer_switch_get_layer(keypos_t key)
     action.code = ACTION_TRANSPARENT;
 
     uint32_t layers = layer_state | default_layer_state;
+#ifdef LAYER_LOOKUP_CACHE
+    /* compare against the state itself, as some keymaps assign layer_state directly */
+    if (layers != layer_cache_state) {
+        layer_cache_invalidate();
+        layer_cache_state = layers;
+    }
+    /* keys outside the matrix, like combos' virtual keys, aren't cached */
+    uint8_t *cached = NULL;
+    if (key.row < MATRIX_ROWS && key.col < MATRIX_COLS) {
+        cached = &layer_cache[key.row][key.col];
+        if (*cached != LAYER_CACHE_INVALID) {
+            return *cached;
+        }
+    }
+#endif
     /* check top layer first */
     for (int8_t i = 31; i >= 0; i--) {
         if (layers & (1UL<<i)) {
             action = action_for_key(i, key);
             if (action.code != ACTION_TRANSPARENT) {
+#ifdef LAYER_LOOKUP_CACHE
+                if (cached) *cached = i;
+#endif
                 return i;
             }
         }
     }
     /* fall back to layer 0 */
+#ifdef LAYER_LOOKUP_CACHE
+    if (cached) *cached = 0;
+#endif
     return 0;
 #else
     return biton32(default_layer_state);
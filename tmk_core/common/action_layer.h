@@ -95,6 +95,14 @@ void update_source_layers_cache(keypos_t key, uint8_t layer);
 uint8_t read_source_layers_cache(keypos_t key);
 #endif
 action_t store_or_get_action(bool pressed, keypos_t key);
+uint8_t store_or_get_layer(bool pressed, keypos_t key);
+
+/* resolved layer cache */
+#if !defined(NO_ACTION_LAYER) && defined(LAYER_LOOKUP_CACHE)
+void layer_cache_invalidate(void);
+#else
+#define layer_cache_invalidate()
+#endif
 
 /* return the topmost non-transparent layer currently associated with key */
 int8_t layer_switch_get_layer(keypos_t key);
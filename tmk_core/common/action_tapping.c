@@ -21,17 +21,23 @@
 #define WITHIN_TAPPING_TERM(e)  (TIMER_DIFF_16(e.time, tapping_key.event.time) < TAPPING_TERM)
 
 
+#if WAITING_BUFFER_SIZE < 2 || WAITING_BUFFER_SIZE > 255
+#   error "WAITING_BUFFER_SIZE must be between 2 and 255"
+#endif
+
 static keyrecord_t tapping_key = {};
 static keyrecord_t waiting_buffer[WAITING_BUFFER_SIZE] = {};
 static uint8_t waiting_buffer_head = 0;
 static uint8_t waiting_buffer_tail = 0;
+static uint8_t waiting_buffer_peak_count = 0;
 
 static bool process_tapping(keyrecord_t *record);
 static bool waiting_buffer_enq(keyrecord_t record);
-static void waiting_buffer_clear(void);
 static bool waiting_buffer_typed(keyevent_t event);
 static bool waiting_buffer_has_anykey_pressed(void);
 static void waiting_buffer_scan_tap(void);
+static void waiting_buffer_process(void);
+static void waiting_buffer_settle(void);
 static void debug_tapping_key(void);
 static void debug_waiting_buffer(void);
 
@@ -47,12 +53,10 @@ void action_tapping_process(keyrecord_t record)
             debug("processed: "); debug_record(record); debug("\n");
         }
     } else {
-        if (!waiting_buffer_enq(record)) {
-            // clear all in case of overflow.
-            debug("OVERFLOW: CLEAR ALL STATES\n");
-            clear_keyboard();
-            waiting_buffer_clear();
-            tapping_key = (keyrecord_t){};
+        while (!waiting_buffer_enq(record)) {
+            // make room by deciding the oldest tap key now, instead of dropping the events
+            debug("OVERFLOW: SETTLE TAPPING KEY\n");
+            waiting_buffer_settle();
         }
     }
 
@@ -60,19 +64,21 @@ void action_tapping_process(keyrecord_t record)
     if (!IS_NOEVENT(record.event) && waiting_buffer_head != waiting_buffer_tail) {
         debug("---- action_exec: process waiting_buffer -----\n");
     }
-    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
-        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
-            debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
-            debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
-        } else {
-            break;
-        }
-    }
+    waiting_buffer_process();
     if (!IS_NOEVENT(record.event)) {
         debug("\n");
     }
 }
 
+/** \brief Waiting buffer peak
+ *
+ * Returns the most events the waiting buffer has held at once.
+ */
+uint8_t waiting_buffer_peak(void)
+{
+    return waiting_buffer_peak_count;
+}
+
 
 /** \brief Tapping
  *
@@ -311,18 +317,54 @@ bool waiting_buffer_enq(keyrecord_t record)
     waiting_buffer[waiting_buffer_head] = record;
     waiting_buffer_head = (waiting_buffer_head + 1) % WAITING_BUFFER_SIZE;
 
+    uint8_t count = (waiting_buffer_head + WAITING_BUFFER_SIZE - waiting_buffer_tail) % WAITING_BUFFER_SIZE;
+    if (count > waiting_buffer_peak_count) {
+        waiting_buffer_peak_count = count;
+    }
+
     debug("waiting_buffer_enq: "); debug_waiting_buffer();
     return true;
 }
 
-/** \brief Waiting buffer clear
+/** \brief Waiting buffer process
  *
- * FIXME: Needs docs
+ * Processes the waiting events in order, until one has to wait again.
  */
-void waiting_buffer_clear(void)
+void waiting_buffer_process(void)
 {
-    waiting_buffer_head = 0;
-    waiting_buffer_tail = 0;
+    for (; waiting_buffer_tail != waiting_buffer_head; waiting_buffer_tail = (waiting_buffer_tail + 1) % WAITING_BUFFER_SIZE) {
+        if (process_tapping(&waiting_buffer[waiting_buffer_tail])) {
+            debug("processed: waiting_buffer["); debug_dec(waiting_buffer_tail); debug("] = ");
+            debug_record(waiting_buffer[waiting_buffer_tail]); debug("\n\n");
+        } else {
+            break;
+        }
+    }
+}
+
+/** \brief Waiting buffer settle
+ *
+ * Settles the tapping state as if TAPPING_TERM had passed: a tap key that is
+ * still undecided is held, since the keys in the buffer were pressed while
+ * it was down. A tap that is registered already stays the tapping key, so
+ * that its release is processed with its tap count. The events behind it
+ * are then processed, which frees at least the oldest one.
+ */
+void waiting_buffer_settle(void)
+{
+    if (IS_TAPPING_PRESSED()) {
+        if (tapping_key.tap.count == 0) {
+            debug("Tapping: End. Buffer full. Not tap(0)\n");
+            process_record(&tapping_key);
+            tapping_key = (keyrecord_t){};
+        } else {
+            debug("Tapping: Buffer full. Keep last tap(>0)\n");
+        }
+    } else {
+        tapping_key = (keyrecord_t){};
+    }
+    debug_tapping_key();
+    waiting_buffer_process();
 }
 
 /** \brief Waiting buffer typed
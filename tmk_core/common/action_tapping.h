@@ -31,11 +31,23 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define TAPPING_TOGGLE  5
 #endif
 
+/* key events held back while a tap key is undecided, one slot is always free */
+#ifndef WAITING_BUFFER_SIZE
 #define WAITING_BUFFER_SIZE 8
+#endif
+
 
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 #ifndef NO_ACTION_TAPPING
 void action_tapping_process(keyrecord_t record);
+uint8_t waiting_buffer_peak(void);
+#endif
+
+#ifdef __cplusplus
+}
 #endif
 
 #endif
@@ -29,19 +29,17 @@ static uint8_t real_mods = 0;
 static uint8_t weak_mods = 0;
 static uint8_t macro_mods = 0;
 
-#ifdef USB_6KRO_ENABLE
-#define RO_ADD(a, b) ((a + b) % KEYBOARD_REPORT_KEYS)
-#define RO_SUB(a, b) ((a - b + KEYBOARD_REPORT_KEYS) % KEYBOARD_REPORT_KEYS)
-#define RO_INC(a) RO_ADD(a, 1)
-#define RO_DEC(a) RO_SUB(a, 1)
-static int8_t cb_head = 0;
-static int8_t cb_tail = 0;
-static int8_t cb_count = 0;
-#endif
-
+report_builder_t keyboard_report_builder = {};
 // TODO: pointer variable is not needed
-//report_keyboard_t keyboard_report = {};
-report_keyboard_t *keyboard_report = &(report_keyboard_t){};
+report_keyboard_t *keyboard_report = &keyboard_report_builder.report;
+
+#ifdef QMK_BATCH_SCAN
+/* report batching: sends are held back until the end of the batch */
+static bool batch_active = false;
+static bool batch_pending = false;
+static report_keyboard_t batch_sent_report;
+static report_keyboard_t batch_pending_report;
+#endif
 
 extern inline void add_key(uint8_t key);
 extern inline void del_key(uint8_t key);
@@ -150,15 +148,57 @@ void send_keyboard_report(void) {
         }
 #endif
         keyboard_report->mods |= oneshot_mods;
-        if (has_anykey(keyboard_report)) {
+        if (has_anykey(&keyboard_report_builder)) {
             clear_oneshot_mods();
         }
     }
 
+#endif
+#ifdef QMK_BATCH_SCAN
+    if (batch_active) {
+        // Sending only the last report of a batch is fine as long as the host
+        // still sees every key press and release: when a key changed since
+        // the last real send is about to change back, push out the held
+        // report first.
+        if (batch_pending && report_hides_change(&batch_sent_report, &batch_pending_report, keyboard_report)) {
+            host_keyboard_send(&batch_pending_report);
+            batch_sent_report = batch_pending_report;
+        }
+        batch_pending_report = *keyboard_report;
+        batch_pending = true;
+        return;
+    }
 #endif
     host_keyboard_send(keyboard_report);
 }
 
+#ifdef QMK_BATCH_SCAN
+/** \brief Begin keyboard report batch
+ *
+ * Holds back keyboard reports until end_keyboard_report_batch() is called,
+ * so that all the events of one matrix scan go out as a single report.
+ */
+void begin_keyboard_report_batch(void)
+{
+    batch_sent_report = *keyboard_report;
+    batch_pending = false;
+    batch_active = true;
+}
+
+/** \brief End keyboard report batch
+ *
+ * Sends the last report held back since begin_keyboard_report_batch(), if any.
+ */
+void end_keyboard_report_batch(void)
+{
+    batch_active = false;
+    if (batch_pending) {
+        batch_pending = false;
+        host_keyboard_send(&batch_pending_report);
+    }
+}
+#endif
+
 /** \brief Get mods
  *
  * FIXME: needs doc
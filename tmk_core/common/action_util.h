@@ -24,21 +24,26 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 extern "C" {
 #endif
 
+extern report_builder_t keyboard_report_builder;
 extern report_keyboard_t *keyboard_report;
 
 void send_keyboard_report(void);
+#ifdef QMK_BATCH_SCAN
+void begin_keyboard_report_batch(void);
+void end_keyboard_report_batch(void);
+#endif
 
 /* key */
 inline void add_key(uint8_t key) {
-  add_key_to_report(keyboard_report, key);
+  add_key_to_report(&keyboard_report_builder, key);
 }
 
 inline void del_key(uint8_t key) {
-  del_key_from_report(keyboard_report, key);
+  del_key_from_report(&keyboard_report_builder, key);
 }
 
 inline void clear_keys(void) {
-  clear_keys_from_report(keyboard_report);
+  clear_keys_from_report(&keyboard_report_builder);
 }
 
 /* modifier */
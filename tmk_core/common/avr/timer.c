@@ -140,6 +140,33 @@ uint32_t timer_elapsed32(uint32_t last)
     return TIMER_DIFF_32(t, last);
 }
 
+/** \brief timer read us
+ *
+ * Adds the timer0 count within the current millisecond, the resolution is
+ * TIMER_PRESCALER / F_CPU.
+ */
+uint32_t timer_read_us(void)
+{
+    uint32_t t;
+    uint8_t raw;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+      t = timer_count;
+      raw = TIMER_RAW;
+      // the compare match that ends this millisecond may not have been handled yet
+#ifndef __AVR_ATmega32A__
+      if (TIFR0 & (1<<OCF0A)) {
+#else
+      if (TIFR & (1<<OCF0)) {
+#endif
+        t++;
+        raw = TIMER_RAW;
+      }
+    }
+
+    return t * 1000 + (uint32_t)raw * 1000 / (TIMER_RAW_TOP + 1);
+}
+
 // excecuted once per 1ms.(excess for just timer count?)
 #ifndef __AVR_ATmega32A__
 #define TIMER_INTERRUPT_VECTOR TIMER0_COMPA_vect
@@ -5,6 +5,8 @@
 static systime_t last_systime = 0;
 static systime_t overflow = 0;
 static uint32_t current_time_ms = 0;
+static systime_t last_systime_us = 0;
+static uint32_t current_time_us = 0;
 
 void timer_init(void) {
   timer_clear();
@@ -14,6 +16,8 @@ void timer_clear(void) {
   last_systime = chVTGetSystemTime();
   overflow = 0;
   current_time_ms = 0;
+  last_systime_us = last_systime;
+  current_time_us = 0;
 }
 
 uint16_t timer_read(void) {
@@ -32,6 +36,19 @@ uint32_t timer_read32(void) {
   return current_time_ms;
 }
 
+uint32_t timer_read_us(void) {
+  // Kept apart from the milliseconds, as ST2MS rounds up. Like timer_read32(), this has to be
+  // called at least once between every wrap around of the system time. The resolution is one
+  // system tick, so 1ms with a CH_CFG_ST_FREQUENCY of 1000.
+  systime_t current_systime = chVTGetSystemTime();
+  systime_t elapsed = current_systime - last_systime_us;
+  last_systime_us = current_systime;
+  // Whole milliseconds first, so that ST2US can't overflow
+  current_time_us += (elapsed / MS2ST(1)) * 1000;
+  current_time_us += ST2US(elapsed % MS2ST(1));
+  return current_time_us;
+}
+
 uint16_t timer_elapsed(uint16_t last) {
   return timer_read() - last;
 }
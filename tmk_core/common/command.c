@@ -28,6 +28,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "bootloader.h"
 #include "action_layer.h"
 #include "action_util.h"
+#include "action_tapping.h"
 #include "eeconfig.h"
 #include "sleep_led.h"
 #include "led.h"
@@ -35,6 +36,14 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "backlight.h"
 #include "quantum.h"
 #include "version.h"
+#ifdef FLIGHT_RECORDER_ENABLE
+#include "flight_recorder.h"
+#include "sendchar.h"
+#endif
+#ifdef PERF_STATS_ENABLE
+#include "perf_stats.h"
+#include "sendchar.h"
+#endif
 
 #ifdef MOUSEKEY_ENABLE
 #include "mousekey.h"
@@ -159,6 +168,14 @@ static void command_common_help(void)
 		STR(MAGIC_KEY_LOCK        ) ":	Lock\n"
 #endif
 
+#ifdef FLIGHT_RECORDER_ENABLE
+		STR(MAGIC_KEY_FLIGHT_RECORDER) ":	Dump Flight Recorder\n"
+#endif
+
+#ifdef PERF_STATS_ENABLE
+		STR(MAGIC_KEY_PERF_STATS) ":	Dump and Reset Performance Stats\n"
+#endif
+
 #ifdef BOOTMAGIC_ENABLE
 		STR(MAGIC_KEY_EEPROM      ) ":	Print EEPROM Settings\n"
 #endif
@@ -244,6 +261,9 @@ static void print_status(void)
     print_val_hex8(keymap_config.nkro);
 #endif
     print_val_hex32(timer_read32());
+#ifndef NO_ACTION_TAPPING
+    print_val_hex8(waiting_buffer_peak());
+#endif
 
 #ifdef PROTOCOL_PJRC
     print_val_hex8(UDCON);
@@ -433,6 +453,23 @@ static bool command_common(uint8_t code)
 			print_status();
             break;
 
+#ifdef FLIGHT_RECORDER_ENABLE
+		// dump the recent key events
+		case MAGIC_KC(MAGIC_KEY_FLIGHT_RECORDER):
+			print("\n");
+			flight_recorder_dump(sendchar);
+            break;
+#endif
+
+#ifdef PERF_STATS_ENABLE
+		// dump the timings since the last dump
+		case MAGIC_KC(MAGIC_KEY_PERF_STATS):
+			print("\n");
+			perf_stats_dump(sendchar);
+			perf_stats_clear();
+            break;
+#endif
+
 #ifdef NKRO_ENABLE
 
 		// NKRO toggle
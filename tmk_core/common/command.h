@@ -148,6 +148,14 @@ bool command_proc(uint8_t code);
 #define MAGIC_KEY_NKRO           N
 #endif
 
+#ifndef MAGIC_KEY_FLIGHT_RECORDER
+#define MAGIC_KEY_FLIGHT_RECORDER R
+#endif
+
+#ifndef MAGIC_KEY_PERF_STATS
+#define MAGIC_KEY_PERF_STATS     T
+#endif
+
 #ifndef MAGIC_KEY_SLEEP_LED
 #define MAGIC_KEY_SLEEP_LED      Z
 
@@ -0,0 +1,167 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include <stddef.h>
+#include "deferred.h"
+#include "timer.h"
+
+#if DEFERRED_MAX + DEFERRED_RESERVED > 254
+#error DEFERRED_MAX must be below 255, less the slots of the features
+#endif
+
+typedef struct {
+    uint16_t deadline;
+    deferred_token_t token;
+    bool reserved;
+    deferred_callback_t callback;
+    void *arg;
+} deferred_t;
+
+static deferred_t heap[DEFERRED_MAX + DEFERRED_RESERVED];
+static uint8_t heap_size = 0;
+/* the callbacks in the heap that don't use a reserved slot */
+static uint8_t keymap_count = 0;
+static deferred_token_t last_token = DEFERRED_TOKEN_NONE;
+
+/* Deadlines are compared relative to each other, so they can wrap around as
+ * long as they are less than half the timer range apart.
+ */
+static inline bool is_before(uint16_t a, uint16_t b)
+{
+    return (int16_t)(a - b) < 0;
+}
+
+static void sift_up(uint8_t i)
+{
+    deferred_t entry = heap[i];
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if (!is_before(entry.deadline, heap[parent].deadline)) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = entry;
+}
+
+static void sift_down(uint8_t i)
+{
+    deferred_t entry = heap[i];
+    for (;;) {
+        uint8_t child = 2 * i + 1;
+        if (child >= heap_size) break;
+        if (child + 1 < heap_size && is_before(heap[child + 1].deadline, heap[child].deadline)) {
+            child++;
+        }
+        if (!is_before(heap[child].deadline, entry.deadline)) break;
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = entry;
+}
+
+static void heap_remove(uint8_t i)
+{
+    if (!heap[i].reserved) keymap_count--;
+    heap_size--;
+    if (i == heap_size) return;
+    heap[i] = heap[heap_size];
+    sift_down(i);
+    sift_up(i);
+}
+
+static deferred_token_t add(uint16_t delay, deferred_callback_t callback, void *arg, bool reserved)
+{
+    if (heap_size >= DEFERRED_MAX + DEFERRED_RESERVED || callback == NULL) {
+        return DEFERRED_TOKEN_NONE;
+    }
+
+    /* the heap is never full of tokens, so one of the next tokens is free */
+    deferred_token_t token = last_token;
+    bool in_use;
+    do {
+        if (++token == DEFERRED_TOKEN_NONE) token++;
+        in_use = false;
+        for (uint8_t i = 0; i < heap_size; i++) {
+            if (heap[i].token == token) {
+                in_use = true;
+                break;
+            }
+        }
+    } while (in_use);
+    last_token = token;
+
+    heap[heap_size] = (deferred_t){
+        .deadline = timer_read() + delay,
+        .token = token,
+        .reserved = reserved,
+        .callback = callback,
+        .arg = arg
+    };
+    sift_up(heap_size++);
+    if (!reserved) keymap_count++;
+    return token;
+}
+
+deferred_token_t deferred_add(uint16_t delay, deferred_callback_t callback, void *arg)
+{
+    if (keymap_count >= DEFERRED_MAX) {
+        return DEFERRED_TOKEN_NONE;
+    }
+    return add(delay, callback, arg, false);
+}
+
+deferred_token_t deferred_add_reserved(uint16_t delay, deferred_callback_t callback, void *arg)
+{
+    /* the features have one callback each at most, so there is always room */
+    return add(delay, callback, arg, true);
+}
+
+bool deferred_cancel(deferred_token_t token)
+{
+    if (token == DEFERRED_TOKEN_NONE) return false;
+
+    for (uint8_t i = 0; i < heap_size; i++) {
+        if (heap[i].token == token) {
+            heap_remove(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void deferred_task(void)
+{
+    /* Callbacks added by the callbacks themselves can be due already, but they
+     * wait for the next call, so that a callback can't keep this loop going.
+     */
+    uint16_t now = timer_read();
+    uint8_t budget = heap_size;
+
+    while (budget-- && heap_size && !is_before(now, heap[0].deadline)) {
+        deferred_t entry = heap[0];
+        heap_remove(0);
+        entry.callback(entry.arg);
+    }
+}
+
+bool deferred_time_left(uint16_t *time_left)
+{
+    if (!heap_size) return false;
+
+    uint16_t now = timer_read();
+    *time_left = is_before(now, heap[0].deadline) ? heap[0].deadline - now : 0;
+    return true;
+}
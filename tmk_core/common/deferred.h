@@ -0,0 +1,86 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DEFERRED_H
+#define DEFERRED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Deferred callbacks
+ *
+ * Features with a timeout register a callback for when it expires, instead of
+ * checking timer_elapsed() on every scan. The pending callbacks are kept in a
+ * min-heap ordered by their deadline, and keyboard_task() only looks at the
+ * earliest one.
+ */
+
+/* slots for the callbacks of the keymap */
+#ifndef DEFERRED_MAX
+#define DEFERRED_MAX 8
+#endif
+
+/* Slots kept for the features that schedule their timeout here. Each of
+ * them has at most one callback pending, so they never run out of slots.
+ */
+#ifdef TAP_DANCE_ENABLE
+#define DEFERRED_TAP_DANCE_SLOTS 1
+#else
+#define DEFERRED_TAP_DANCE_SLOTS 0
+#endif
+#ifdef COMBO_ENABLE
+#define DEFERRED_COMBO_SLOTS 1
+#else
+#define DEFERRED_COMBO_SLOTS 0
+#endif
+/* the leader key is always built, its timeout is scheduled with sequences */
+#if defined(LEADER_SEQUENCE_COUNT) && LEADER_SEQUENCE_COUNT > 0 && !defined(DISABLE_LEADER)
+#define DEFERRED_LEADER_SLOTS 1
+#else
+#define DEFERRED_LEADER_SLOTS 0
+#endif
+#define DEFERRED_RESERVED (DEFERRED_TAP_DANCE_SLOTS + DEFERRED_COMBO_SLOTS + DEFERRED_LEADER_SLOTS)
+
+typedef uint8_t deferred_token_t;
+#define DEFERRED_TOKEN_NONE 0
+
+typedef void (*deferred_callback_t)(void *arg);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Calls callback with arg once delay ms have elapsed. Returns a token for
+ * deferred_cancel(), or DEFERRED_TOKEN_NONE if all DEFERRED_MAX slots are in use.
+ */
+deferred_token_t deferred_add(uint16_t delay, deferred_callback_t callback, void *arg);
+/* Like deferred_add(), for the features counted in DEFERRED_RESERVED, which
+ * use their own slots
+ */
+deferred_token_t deferred_add_reserved(uint16_t delay, deferred_callback_t callback, void *arg);
+/* Removes a pending callback, returns false if it has already run */
+bool deferred_cancel(deferred_token_t token);
+/* Runs the callbacks that are due, called from keyboard_task() */
+void deferred_task(void);
+/* How long until the next callback is due, false when nothing is pending */
+bool deferred_time_left(uint16_t *time_left);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,106 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "flight_recorder.h"
+#include "action_layer.h"
+#include "text_dump.h"
+
+#if FLIGHT_RECORDER_SIZE > 255
+#   error "FLIGHT_RECORDER_SIZE must be at most 255"
+#endif
+
+static flight_record_t records[FLIGHT_RECORDER_SIZE];
+static uint8_t records_head = 0;
+static uint8_t records_count = 0;
+
+/** \brief Flight recorder record
+ *
+ * Keeps the event, overwriting the oldest one when the recorder is full.
+ */
+void flight_recorder_record(keyevent_t event)
+{
+    records[records_head] = (flight_record_t){
+        .time = event.time,
+        .key = event.key,
+        .pressed = event.pressed,
+        .layer_state = layer_state
+    };
+    records_head = records_head + 1 == FLIGHT_RECORDER_SIZE ? 0 : records_head + 1;
+    if (records_count < FLIGHT_RECORDER_SIZE)
+        records_count++;
+}
+
+void flight_recorder_clear(void)
+{
+    records_head = 0;
+    records_count = 0;
+}
+
+uint8_t flight_recorder_count(void)
+{
+    return records_count;
+}
+
+flight_record_t flight_recorder_get(uint8_t index)
+{
+    uint16_t slot = records_head + FLIGHT_RECORDER_SIZE - records_count + index;
+    return records[slot % FLIGHT_RECORDER_SIZE];
+}
+
+static void send_hex(int8_t (*send)(uint8_t c), uint32_t value, uint8_t digits)
+{
+    send(' ');
+    while (digits--) {
+        uint8_t nibble = (value >> (digits * 4)) & 0xF;
+        send(nibble < 10 ? '0' + nibble : 'a' + nibble - 10);
+    }
+}
+
+/** \brief Flight recorder dump
+ *
+ * Writes the recorded events, oldest first, in the format described in
+ * flight_recorder.h.
+ */
+void flight_recorder_dump(int8_t (*send)(uint8_t c))
+{
+    text_send_str(send, "FLIGHT");
+    send_hex(send, 1, 1);
+    send_hex(send, records_count, 2);
+    send('\n');
+    for (uint8_t i = 0; i < records_count; i++) {
+        flight_record_t record = flight_recorder_get(i);
+        send('E');
+        send_hex(send, record.time, 4);
+        send_hex(send, record.key.row, 2);
+        send_hex(send, record.key.col, 2);
+        send_hex(send, record.pressed, 1);
+        send_hex(send, record.layer_state, 8);
+        send('\n');
+    }
+    text_send_str(send, "END\n");
+}
+
+#ifdef RAW_ENABLE
+/** \brief Flight recorder dump raw HID
+ *
+ * Sends the dump as text over raw HID, the last report is padded with zeros.
+ */
+void flight_recorder_dump_raw_hid(void)
+{
+    text_dump_raw_hid(flight_recorder_dump);
+}
+#endif
@@ -0,0 +1,69 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "keyboard.h"
+
+/*
+ * Flight recorder: keeps the last key events that action_exec() processed,
+ * with the layer state they were processed in, so that they can be dumped
+ * after a misfire and replayed by the tests.
+ *
+ * The dump is text, one event per line, all numbers in hex:
+ *
+ *   FLIGHT 1 <count>
+ *   E <time> <row> <col> <pressed> <layer_state>
+ *   ...
+ *   END
+ */
+
+/* events kept, the oldest ones are overwritten */
+#ifndef FLIGHT_RECORDER_SIZE
+#   define FLIGHT_RECORDER_SIZE 32
+#endif
+
+typedef struct {
+    uint16_t time;
+    keypos_t key;
+    bool pressed;
+    uint32_t layer_state;
+} flight_record_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void flight_recorder_record(keyevent_t event);
+void flight_recorder_clear(void);
+uint8_t flight_recorder_count(void);
+/* the index counts from the oldest event */
+flight_record_t flight_recorder_get(uint8_t index);
+/* writes the dump one character at a time, sendchar() writes it to the console */
+void flight_recorder_dump(int8_t (*send)(uint8_t c));
+#ifdef RAW_ENABLE
+void flight_recorder_dump_raw_hid(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -16,16 +16,41 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
 #include <stdint.h>
+#include <string.h>
 //#include <avr/interrupt.h>
 #include "keycode.h"
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#include "perf_stats.h"
+#ifdef HOST_REPORT_QUEUE
+#   include "timer.h"
+#endif
 
 static host_driver_t *driver;
 static uint16_t last_system_report = 0;
 static uint16_t last_consumer_report = 0;
 
+#ifdef HOST_REPORT_QUEUE
+#   ifndef HOST_REPORT_QUEUE_SIZE
+#       define HOST_REPORT_QUEUE_SIZE 8
+#   endif
+
+/* keyboard reports waiting for a USB frame, oldest first */
+static report_keyboard_t report_queue[HOST_REPORT_QUEUE_SIZE];
+static uint8_t report_queue_head = 0;
+static uint8_t report_queue_count = 0;
+static report_keyboard_t last_keyboard_report;
+static bool last_keyboard_report_valid = false;
+static uint8_t last_mouse_buttons = 0;
+static bool last_mouse_report_valid = false;
+
+/* set from the start of frame interrupt, see host_start_of_frame() */
+static volatile bool frame_started = true;
+static volatile bool frame_events = false;
+static uint16_t frame_time;
+#endif
+
 
 void host_set_driver(host_driver_t *d)
 {
@@ -42,11 +67,10 @@ uint8_t host_keyboard_leds(void)
     if (!driver) return 0;
     return (*driver->keyboard_leds)();
 }
-/* send report */
-void host_keyboard_send(report_keyboard_t *report)
+
+static void send_keyboard(report_keyboard_t *report)
 {
-    if (!driver) return;
-    (*driver->send_keyboard)(report);
+    PERF_MEASURE(PERF_REPORT_SEND, (*driver->send_keyboard)(report));
 
     if (debug_keyboard) {
         dprint("keyboard_report: ");
@@ -57,9 +81,116 @@ void host_keyboard_send(report_keyboard_t *report)
     }
 }
 
+#ifdef HOST_REPORT_QUEUE
+/** \brief Take frame
+ *
+ * Returns true once for every USB frame, the keyboard endpoint can take one
+ * report per frame. Without start of frame events from the protocol a frame
+ * is a timer millisecond instead.
+ */
+static bool take_frame(void)
+{
+    if (!frame_events) {
+        uint16_t now = timer_read();
+        if (now != frame_time) {
+            frame_time = now;
+            frame_started = true;
+        }
+    }
+    if (!frame_started) return false;
+    frame_started = false;
+    return true;
+}
+
+static void send_queued_keyboard(report_keyboard_t *report)
+{
+    send_keyboard(report);
+    last_keyboard_report = *report;
+    last_keyboard_report_valid = true;
+}
+
+static report_keyboard_t *report_queue_at(uint8_t index)
+{
+    return &report_queue[(report_queue_head + index) % HOST_REPORT_QUEUE_SIZE];
+}
+
+static void report_queue_send_head(void)
+{
+    send_queued_keyboard(report_queue_at(0));
+    report_queue_head = (report_queue_head + 1) % HOST_REPORT_QUEUE_SIZE;
+    report_queue_count--;
+}
+
+/** \brief Start of frame
+ *
+ * Called by the protocol from the USB start of frame interrupt.
+ */
+void host_start_of_frame(void)
+{
+    frame_events = true;
+    frame_started = true;
+}
+
+/** \brief Host task
+ *
+ * Sends the oldest queued keyboard report, once per USB frame.
+ */
+void host_task(void)
+{
+    if (!driver) return;
+    if (report_queue_count && take_frame()) {
+        report_queue_send_head();
+    }
+}
+#endif
+
+/* send report */
+void host_keyboard_send(report_keyboard_t *report)
+{
+    if (!driver) return;
+#ifdef HOST_REPORT_QUEUE
+    /* The first report of a frame goes out right away, the ones after it
+     * wait for the next frames. A report that only extends the changes of
+     * the newest waiting one replaces it, but when it changes a key or
+     * modifier back both are kept, so the host sees every press and
+     * release. Reports that change nothing are dropped. */
+    if (report_queue_count) {
+        report_keyboard_t *newest = report_queue_at(report_queue_count - 1);
+        if (memcmp(newest, report, sizeof(report_keyboard_t)) == 0) return;
+
+        report_keyboard_t *before = report_queue_count > 1 ? report_queue_at(report_queue_count - 2) : &last_keyboard_report;
+        if (!report_hides_change(before, newest, report)) {
+            *newest = *report;
+            return;
+        }
+        if (report_queue_count == HOST_REPORT_QUEUE_SIZE) {
+            report_queue_send_head();
+        }
+        *report_queue_at(report_queue_count++) = *report;
+        return;
+    }
+    if (last_keyboard_report_valid && memcmp(&last_keyboard_report, report, sizeof(report_keyboard_t)) == 0) return;
+    if (take_frame()) {
+        send_queued_keyboard(report);
+        return;
+    }
+    *report_queue_at(report_queue_count++) = *report;
+#else
+    send_keyboard(report);
+#endif
+}
+
 void host_mouse_send(report_mouse_t *report)
 {
     if (!driver) return;
+#ifdef HOST_REPORT_QUEUE
+    /* a report without movement only tells the host about the buttons */
+    if (!report->x && !report->y && !report->v && !report->h) {
+        if (last_mouse_report_valid && report->buttons == last_mouse_buttons) return;
+    }
+    last_mouse_buttons = report->buttons;
+    last_mouse_report_valid = true;
+#endif
     (*driver->send_mouse)(report);
 }
 
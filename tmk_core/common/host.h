@@ -46,6 +46,11 @@ void host_consumer_send(uint16_t data);
 uint16_t host_last_system_report(void);
 uint16_t host_last_consumer_report(void);
 
+#ifdef HOST_REPORT_QUEUE
+void host_start_of_frame(void);
+void host_task(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
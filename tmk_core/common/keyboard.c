@@ -31,6 +31,9 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "eeconfig.h"
 #include "backlight.h"
 #include "action_layer.h"
+#include "action_util.h"
+#include "deferred.h"
+#include "perf_stats.h"
 #ifdef BOOTMAGIC_ENABLE
 #   include "bootmagic.h"
 #else
@@ -73,13 +76,18 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #   include "hd44780.h"
 #endif
 
+#ifdef QMK_BATCH_SCAN
+#   ifndef QMK_BATCH_SCAN_SIZE
+#       define QMK_BATCH_SCAN_SIZE 8
+#   endif
+#endif
+
 #ifdef MATRIX_HAS_GHOST
-extern const uint16_t keymaps[][MATRIX_ROWS][MATRIX_COLS];
 static matrix_row_t get_real_keys(uint8_t row, matrix_row_t rowdata){
     matrix_row_t out = 0;
     for (uint8_t col = 0; col < MATRIX_COLS; col++) {
         //read each key in the row data and check if the keymap defines it as a real key
-        if (pgm_read_byte(&keymaps[0][row][col]) && (rowdata & (1<<col))){
+        if (keymap_key_to_keycode(0, (keypos_t){ .row = row, .col = col }) && (rowdata & (1<<col))){
             //this creates new row data, if a key is defined in the keymap, it will be set here
             out |= 1<<col;
         }
@@ -128,6 +136,33 @@ __attribute__ ((weak))
 void matrix_setup(void) {
 }
 
+/** \brief matrix_get_key_time
+ *
+ * The time a switch changed, for matrices that know it better than the scan
+ * does, like the slave half of a split keyboard. Returns 0 when unknown.
+ */
+__attribute__ ((weak))
+uint16_t matrix_get_key_time(uint8_t row, uint8_t col) {
+    return 0;
+}
+
+/** \brief Time stamp for a key event
+ *
+ * Uses the time the matrix saw the change when it has one, but never before
+ * the previous event so that the time between events can't go negative.
+ */
+static uint16_t key_event_time(uint8_t row, uint8_t col, uint16_t now) {
+    static uint16_t last_time = 0;
+    uint16_t time = matrix_get_key_time(row, col);
+    if (!time) {
+        time = now;
+    } else if (TIMER_DIFF_16(now, time) > TIMER_DIFF_16(now, last_time)) {
+        time = last_time;
+    }
+    last_time = time | 1; /* time should not be 0 */
+    return last_time;
+}
+
 /** \brief keyboard_setup
  *
  * FIXME: needs doc
@@ -215,8 +250,19 @@ void keyboard_task(void)
 #ifdef QMK_KEYS_PER_SCAN
     uint8_t keys_processed = 0;
 #endif
+#ifdef QMK_BATCH_SCAN
+    // every change found in this scan is queued and shares one timestamp
+    keyevent_t batch[QMK_BATCH_SCAN_SIZE];
+    uint8_t batch_count = 0;
+    const uint16_t batch_time = timer_read() | 1; /* time should not be 0 */
+#endif
 
-    matrix_scan();
+#ifdef DEFERRED_ENABLE
+    // run the feature timeouts that are due before looking at new key events
+    deferred_task();
+#endif
+
+    PERF_MEASURE(PERF_MATRIX_SCAN, matrix_scan());
     if (is_keyboard_master()) {
         for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
             matrix_row = matrix_get_row(r);
@@ -237,12 +283,24 @@ void keyboard_task(void)
                 //matrix_ghost[r] = matrix_row;
 #endif
                 if (debug_matrix) matrix_print();
+                PERF_KEY_CHANGED();
                 for (uint8_t c = 0; c < MATRIX_COLS; c++) {
                     if (matrix_change & ((matrix_row_t)1<<c)) {
+#ifdef QMK_BATCH_SCAN
+                        batch[batch_count++] = (keyevent_t){
+                            .key = (keypos_t){ .row = r, .col = c },
+                            .pressed = (matrix_row & ((matrix_row_t)1<<c)),
+                            .time = key_event_time(r, c, batch_time)
+                        };
+                        matrix_prev[r] ^= ((matrix_row_t)1<<c);
+                        // leave the rest of the changes for the next scan
+                        if (batch_count >= QMK_BATCH_SCAN_SIZE)
+                            goto MATRIX_BATCH_END;
+#else
                         action_exec((keyevent_t){
                             .key = (keypos_t){ .row = r, .col = c },
                             .pressed = (matrix_row & ((matrix_row_t)1<<c)),
-                            .time = (timer_read() | 1) /* time should not be 0 */
+                            .time = key_event_time(r, c, timer_read())
                         });
                         // record a processed key
                         matrix_prev[r] ^= ((matrix_row_t)1<<c);
@@ -252,11 +310,24 @@ void keyboard_task(void)
 #endif
                         // process a key per task call
                         goto MATRIX_LOOP_END;
+#endif
                     }
                 }
             }
         }
     }
+#ifdef QMK_BATCH_SCAN
+MATRIX_BATCH_END:
+    if (batch_count) {
+        // run the whole batch in matrix order, and let the host see one report
+        begin_keyboard_report_batch();
+        for (uint8_t i = 0; i < batch_count; i++) {
+            action_exec(batch[i]);
+        }
+        end_keyboard_report_batch();
+        goto MATRIX_LOOP_END;
+    }
+#endif
     // call with pseudo tick event when no real key event.
 #ifdef QMK_KEYS_PER_SCAN
     // we can get here with some keys processed now.
@@ -299,6 +370,10 @@ MATRIX_LOOP_END:
     midi_task();
 #endif
 
+#ifdef HOST_REPORT_QUEUE
+    host_task();
+#endif
+
     // update LED
     if (led_status != host_keyboard_leds()) {
         led_status = host_keyboard_leds();
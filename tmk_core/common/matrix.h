@@ -66,6 +66,8 @@ bool matrix_is_on(uint8_t row, uint8_t col);
 matrix_row_t matrix_get_row(uint8_t row);
 /* print matrix for debug */
 void matrix_print(void);
+/* time a switch changed, for matrices that see it before the scan. 0 if unknown. (optional) */
+uint16_t matrix_get_key_time(uint8_t row, uint8_t col);
 
 
 /* power control */
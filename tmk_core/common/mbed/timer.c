@@ -39,3 +39,15 @@ uint32_t timer_elapsed32(uint32_t last)
 {
     return TIMER_DIFF_32(timer_read32(), last);
 }
+
+uint32_t timer_read_us(void)
+{
+    uint32_t ms, ticks;
+
+    // SysTick counts down from LOAD once per millisecond
+    do {
+        ms = timer_count;
+        ticks = SysTick->VAL;
+    } while (ms != timer_count);
+    return ms * 1000 + (SysTick->LOAD - ticks) * 1000 / (SysTick->LOAD + 1);
+}
@@ -0,0 +1,182 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <stdbool.h>
+#include "perf_stats.h"
+#include "text_dump.h"
+
+static perf_stat_t stats[PERF_COUNTERS];
+
+static uint32_t scan_begin;
+static bool change_pending = false;
+static uint32_t change_begin;
+
+static uint16_t scans = 0;
+static uint16_t scan_rate = 0;
+static uint16_t scan_rate_time;
+static bool scan_rate_started = false;
+
+static const char *const counter_names[PERF_COUNTERS] = {
+    [PERF_MATRIX_SCAN]    = "matrix_scan",
+    [PERF_PROCESS_RECORD] = "process_record",
+    [PERF_LIGHTING]       = "lighting",
+    [PERF_REPORT_SEND]    = "report_send",
+    [PERF_SCAN_TO_REPORT] = "scan_to_report",
+};
+
+static void record(perf_counter_t counter, uint32_t time)
+{
+    perf_stat_t *stat = &stats[counter];
+    // halve both instead of overflowing, the average stays the same
+    if (stat->total + time < stat->total) {
+        stat->total >>= 1;
+        stat->count >>= 1;
+    }
+    if (!stat->count || time < stat->min)
+        stat->min = time;
+    if (time > stat->max)
+        stat->max = time;
+    stat->count++;
+    stat->total += time;
+
+    uint8_t bucket = 0;
+    while (time && bucket < PERF_HISTOGRAM_SIZE - 1) {
+        time >>= 1;
+        bucket++;
+    }
+    if (stat->histogram[bucket] < UINT16_MAX)
+        stat->histogram[bucket]++;
+}
+
+static void count_scan(void)
+{
+    if (!scan_rate_started) {
+        scan_rate_time = timer_read();
+        scan_rate_started = true;
+        return;
+    }
+    scans++;
+    if (timer_elapsed(scan_rate_time) >= 1000) {
+        scan_rate = scans;
+        scans = 0;
+        scan_rate_time += 1000;
+    }
+}
+
+/** \brief Perf stats end
+ *
+ * Records the time since begin. Sending a keyboard report also ends the
+ * scan to report latency of a key change.
+ */
+void perf_stats_end(perf_counter_t counter, uint32_t begin)
+{
+    uint32_t now = timer_read_us();
+    record(counter, now - begin);
+    if (counter == PERF_MATRIX_SCAN) {
+        scan_begin = begin;
+        count_scan();
+    } else if (counter == PERF_REPORT_SEND && change_pending) {
+        record(PERF_SCAN_TO_REPORT, now - change_begin);
+        change_pending = false;
+    }
+}
+
+/** \brief Perf stats key changed
+ *
+ * Starts the scan to report latency at the start of the last matrix scan,
+ * unless an earlier change is still waiting for a report.
+ */
+void perf_stats_key_changed(void)
+{
+    if (!change_pending) {
+        change_begin = scan_begin;
+        change_pending = true;
+    }
+}
+
+const perf_stat_t *perf_stats_get(perf_counter_t counter)
+{
+    return &stats[counter];
+}
+
+const char *perf_stats_name(perf_counter_t counter)
+{
+    return counter_names[counter];
+}
+
+uint16_t perf_stats_scan_rate(void)
+{
+    return scan_rate;
+}
+
+void perf_stats_clear(void)
+{
+    for (uint8_t i = 0; i < PERF_COUNTERS; i++)
+        stats[i] = (perf_stat_t){};
+    change_pending = false;
+    scans = 0;
+    scan_rate = 0;
+    scan_rate_started = false;
+}
+
+static void send_dec(int8_t (*send)(uint8_t c), uint32_t value)
+{
+    char digits[10];
+    uint8_t length = 0;
+    do {
+        digits[length++] = '0' + value % 10;
+        value /= 10;
+    } while (value);
+    send(' ');
+    while (length)
+        send(digits[--length]);
+}
+
+/** \brief Perf stats dump
+ *
+ * Writes the stats in the format described in perf_stats.h.
+ */
+void perf_stats_dump(int8_t (*send)(uint8_t c))
+{
+    text_send_str(send, "STATS");
+    send_dec(send, 1);
+    send_dec(send, scan_rate);
+    send('\n');
+    for (uint8_t i = 0; i < PERF_COUNTERS; i++) {
+        const perf_stat_t *stat = &stats[i];
+        text_send_str(send, counter_names[i]);
+        send_dec(send, stat->count);
+        send_dec(send, stat->min);
+        send_dec(send, stat->count ? stat->total / stat->count : 0);
+        send_dec(send, stat->max);
+        for (uint8_t bucket = 0; bucket < PERF_HISTOGRAM_SIZE; bucket++)
+            send_dec(send, stat->histogram[bucket]);
+        send('\n');
+    }
+    text_send_str(send, "END\n");
+}
+
+#ifdef RAW_ENABLE
+/** \brief Perf stats dump raw HID
+ *
+ * Sends the dump as text over raw HID, like flight_recorder_dump_raw_hid().
+ */
+void perf_stats_dump_raw_hid(void)
+{
+    text_dump_raw_hid(perf_stats_dump);
+}
+#endif
@@ -0,0 +1,101 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <stdint.h>
+#include "timer.h"
+
+/*
+ * Performance stats: how long the matrix scan, process_record(), the
+ * lighting tasks and sending a keyboard report take, how long it takes from
+ * the scan that finds a key change to the next keyboard report, and how many
+ * scans keyboard_task() does per second.
+ *
+ * Times are in microseconds from timer_read_us(), its resolution depends on
+ * the platform. The matrix scan includes matrix_scan_quantum(), and so the
+ * lighting tasks run from there. A key change that doesn't send anything,
+ * like a layer key, counts towards the latency of the next report.
+ *
+ * The dump is text, one line per counter, all numbers in decimal:
+ *
+ *   STATS 1 <scans per second>
+ *   <name> <count> <min> <avg> <max> <histogram...>
+ *   ...
+ *   END
+ *
+ * Bucket n of the histogram counts the times of n bits, 0, 1, 2-3, 4-7 and so
+ * on, the last bucket also counts everything longer.
+ */
+
+#define PERF_HISTOGRAM_SIZE 16
+
+typedef enum {
+    PERF_MATRIX_SCAN,
+    PERF_PROCESS_RECORD,
+    PERF_LIGHTING,
+    PERF_REPORT_SEND,
+    PERF_SCAN_TO_REPORT,
+    PERF_COUNTERS
+} perf_counter_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t total;
+    uint32_t min;
+    uint32_t max;
+    uint16_t histogram[PERF_HISTOGRAM_SIZE];
+} perf_stat_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* records the time since begin, use PERF_MEASURE() instead */
+void perf_stats_end(perf_counter_t counter, uint32_t begin);
+/* the last matrix scan found a key change */
+void perf_stats_key_changed(void);
+const perf_stat_t *perf_stats_get(perf_counter_t counter);
+/* the name of the counter in the dump */
+const char *perf_stats_name(perf_counter_t counter);
+/* matrix scans in the last full second */
+uint16_t perf_stats_scan_rate(void);
+void perf_stats_clear(void);
+/* writes the dump one character at a time, sendchar() writes it to the console */
+void perf_stats_dump(int8_t (*send)(uint8_t c));
+#ifdef RAW_ENABLE
+void perf_stats_dump_raw_hid(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+/* Without PERF_STATS_ENABLE these only run the code */
+#ifdef PERF_STATS_ENABLE
+#   define PERF_MEASURE(counter, code) do { \
+        const uint32_t perf_begin = timer_read_us(); \
+        code; \
+        perf_stats_end(counter, perf_begin); \
+    } while (0)
+#   define PERF_KEY_CHANGED() perf_stats_key_changed()
+#else
+#   define PERF_MEASURE(counter, code) do { code; } while (0)
+#   define PERF_KEY_CHANGED()
+#endif
+
+#endif
@@ -22,154 +22,83 @@
 
 /** \brief has_anykey
  *
- * FIXME: Needs doc
+ * Returns the number of keys in the report, not counting the modifiers.
  */
-uint8_t has_anykey(report_keyboard_t* keyboard_report)
+uint8_t has_anykey(report_builder_t* builder)
 {
-    uint8_t cnt = 0;
-    for (uint8_t i = 1; i < KEYBOARD_REPORT_SIZE; i++) {
-        if (keyboard_report->raw[i])
-            cnt++;
-    }
-    return cnt;
+    return builder->key_count;
 }
 
 /** \brief get_first_key
  *
- * FIXME: Needs doc
+ * Returns the oldest key in a 6KRO report, the lowest one in an NKRO report,
+ * or 0 when the report has no keys.
  */
-uint8_t get_first_key(report_keyboard_t* keyboard_report)
+uint8_t get_first_key(report_builder_t* builder)
 {
+    if (!builder->key_count)
+        return 0;
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
-        uint8_t i = 0;
-        for (; i < KEYBOARD_REPORT_BITS && !keyboard_report->nkro.bits[i]; i++)
-            ;
-        return i<<3 | biton(keyboard_report->nkro.bits[i]);
+        return builder->first_key;
     }
 #endif
-#ifdef USB_6KRO_ENABLE
-    uint8_t i = cb_head;
-    do {
-        if (keyboard_report->keys[i] != 0) {
-            break;
-        }
-        i = RO_INC(i);
-    } while (i != cb_tail);
-    return keyboard_report->keys[i];
-#else
-    return keyboard_report->keys[0];
-#endif
+    return builder->report.keys[builder->key_head];
+}
+
+/** \brief key slot
+ *
+ * Returns the index in keys of the nth oldest key of a 6KRO report.
+ */
+static uint8_t key_slot(report_builder_t* builder, uint8_t n)
+{
+    uint8_t slot = builder->key_head + n;
+    return slot >= KEYBOARD_REPORT_KEYS ? slot - KEYBOARD_REPORT_KEYS : slot;
 }
 
 /** \brief add key byte
  *
- * FIXME: Needs doc
+ * Appends the key after the newest one, without moving any of the others.
  */
-void add_key_byte(report_keyboard_t* keyboard_report, uint8_t code)
+static void add_key_byte(report_builder_t* builder, uint8_t code)
 {
-#ifdef USB_6KRO_ENABLE
-    int8_t i = cb_head;
-    int8_t empty = -1;
-    if (cb_count) {
-        do {
-            if (keyboard_report->keys[i] == code) {
-                return;
-            }
-            if (empty == -1 && keyboard_report->keys[i] == 0) {
-                empty = i;
-            }
-            i = RO_INC(i);
-        } while (i != cb_tail);
-        if (i == cb_tail) {
-            if (cb_tail == cb_head) {
-                // buffer is full
-                if (empty == -1) {
-                    // pop head when has no empty space
-                    cb_head = RO_INC(cb_head);
-                    cb_count--;
-                }
-                else {
-                    // left shift when has empty space
-                    uint8_t offset = 1;
-                    i = RO_INC(empty);
-                    do {
-                        if (keyboard_report->keys[i] != 0) {
-                            keyboard_report->keys[empty] = keyboard_report->keys[i];
-                            keyboard_report->keys[i] = 0;
-                            empty = RO_INC(empty);
-                        }
-                        else {
-                            offset++;
-                        }
-                        i = RO_INC(i);
-                    } while (i != cb_tail);
-                    cb_tail = RO_SUB(cb_tail, offset);
-                }
-            }
-        }
-    }
-    // add to tail
-    keyboard_report->keys[cb_tail] = code;
-    cb_tail = RO_INC(cb_tail);
-    cb_count++;
-#else
-    int8_t i = 0;
-    int8_t empty = -1;
-    for (; i < KEYBOARD_REPORT_KEYS; i++) {
-        if (keyboard_report->keys[i] == code) {
-            break;
-        }
-        if (empty == -1 && keyboard_report->keys[i] == 0) {
-            empty = i;
-        }
-    }
-    if (i == KEYBOARD_REPORT_KEYS) {
-        if (empty != -1) {
-            keyboard_report->keys[empty] = code;
-        }
+    uint8_t* keys = builder->report.keys;
+    for (uint8_t n = 0; n < builder->key_count; n++) {
+        if (keys[key_slot(builder, n)] == code)
+            return;
     }
+    if (builder->key_count == KEYBOARD_REPORT_KEYS) {
+#ifdef USB_6KRO_ENABLE
+        // the new key takes the place of the oldest one
+        keys[builder->key_head] = code;
+        builder->key_head = key_slot(builder, 1);
 #endif
+        return;
+    }
+    keys[key_slot(builder, builder->key_count)] = code;
+    builder->key_count++;
 }
 
 /** \brief del key byte
  *
- * FIXME: Needs doc
+ * Moves the keys newer than the removed one back by one, so that the keys
+ * stay in order without gaps.
  */
-void del_key_byte(report_keyboard_t* keyboard_report, uint8_t code)
+static void del_key_byte(report_builder_t* builder, uint8_t code)
 {
-#ifdef USB_6KRO_ENABLE
-    uint8_t i = cb_head;
-    if (cb_count) {
-        do {
-            if (keyboard_report->keys[i] == code) {
-                keyboard_report->keys[i] = 0;
-                cb_count--;
-                if (cb_count == 0) {
-                    // reset head and tail
-                    cb_tail = cb_head = 0;
-                }
-                if (i == RO_DEC(cb_tail)) {
-                    // left shift when next to tail
-                    do {
-                        cb_tail = RO_DEC(cb_tail);
-                        if (keyboard_report->keys[RO_DEC(cb_tail)] != 0) {
-                            break;
-                        }
-                    } while (cb_tail != cb_head);
-                }
-                break;
+    uint8_t* keys = builder->report.keys;
+    for (uint8_t n = 0; n < builder->key_count; n++) {
+        if (keys[key_slot(builder, n)] == code) {
+            for (; n + 1 < builder->key_count; n++) {
+                keys[key_slot(builder, n)] = keys[key_slot(builder, n + 1)];
             }
-            i = RO_INC(i);
-        } while (i != cb_tail);
-    }
-#else
-    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
-        if (keyboard_report->keys[i] == code) {
-            keyboard_report->keys[i] = 0;
+            keys[key_slot(builder, n)] = 0;
+            if (--builder->key_count == 0) {
+                builder->key_head = 0;
+            }
+            return;
         }
     }
-#endif
 }
 
 #ifdef NKRO_ENABLE
@@ -177,10 +106,16 @@ void del_key_byte(report_keyboard_t* keyboard_report, uint8_t code)
  *
  * FIXME: Needs doc
  */
-void add_key_bit(report_keyboard_t* keyboard_report, uint8_t code)
+static void add_key_bit(report_builder_t* builder, uint8_t code)
 {
     if ((code>>3) < KEYBOARD_REPORT_BITS) {
-        keyboard_report->nkro.bits[code>>3] |= 1<<(code&7);
+        uint8_t* bits = &builder->report.nkro.bits[code>>3];
+        if (*bits & 1<<(code&7))
+            return;
+        *bits |= 1<<(code&7);
+        if (!builder->key_count || code < builder->first_key)
+            builder->first_key = code;
+        builder->key_count++;
     } else {
         dprintf("add_key_bit: can't add: %02X\n", code);
     }
@@ -188,12 +123,22 @@ void add_key_bit(report_keyboard_t* keyboard_report, uint8_t code)
 
 /** \brief del key bit
  *
- * FIXME: Needs doc
+ * Only looks for the next key when the first one is removed.
  */
-void del_key_bit(report_keyboard_t* keyboard_report, uint8_t code)
+static void del_key_bit(report_builder_t* builder, uint8_t code)
 {
     if ((code>>3) < KEYBOARD_REPORT_BITS) {
-        keyboard_report->nkro.bits[code>>3] &= ~(1<<(code&7));
+        uint8_t* bits = builder->report.nkro.bits;
+        if (!(bits[code>>3] & 1<<(code&7)))
+            return;
+        bits[code>>3] &= ~(1<<(code&7));
+        builder->key_count--;
+        if (builder->key_count && code == builder->first_key) {
+            uint8_t i = code>>3;
+            for (; !bits[i]; i++)
+                ;
+            builder->first_key = i<<3 | biton(bits[i] & -bits[i]);
+        }
     } else {
         dprintf("del_key_bit: can't del: %02X\n", code);
     }
@@ -204,40 +149,83 @@ void del_key_bit(report_keyboard_t* keyboard_report, uint8_t code)
  *
  * FIXME: Needs doc
  */
-void add_key_to_report(report_keyboard_t* keyboard_report, uint8_t key)
+void add_key_to_report(report_builder_t* builder, uint8_t key)
 {
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
-        add_key_bit(keyboard_report, key);
+        add_key_bit(builder, key);
         return;
     }
 #endif
-    add_key_byte(keyboard_report, key);
+    add_key_byte(builder, key);
 }
 
 /** \brief del key from report
  *
  * FIXME: Needs doc
  */
-void del_key_from_report(report_keyboard_t* keyboard_report, uint8_t key)
+void del_key_from_report(report_builder_t* builder, uint8_t key)
 {
 #ifdef NKRO_ENABLE
     if (keyboard_protocol && keymap_config.nkro) {
-        del_key_bit(keyboard_report, key);
+        del_key_bit(builder, key);
         return;
     }
 #endif
-    del_key_byte(keyboard_report, key);
+    del_key_byte(builder, key);
 }
 
 /** \brief clear key from report
  *
- * FIXME: Needs doc
+ * Removes all the keys, but not the modifiers.
  */
-void clear_keys_from_report(report_keyboard_t* keyboard_report)
+void clear_keys_from_report(report_builder_t* builder)
 {
     // not clear mods
     for (int8_t i = 1; i < KEYBOARD_REPORT_SIZE; i++) {
-        keyboard_report->raw[i] = 0;
+        builder->report.raw[i] = 0;
+    }
+    builder->key_count = 0;
+    builder->key_head = 0;
+}
+
+#if defined(QMK_BATCH_SCAN) || defined(HOST_REPORT_QUEUE)
+static bool has_key_byte(report_keyboard_t* keyboard_report, uint8_t code)
+{
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (keyboard_report->keys[i] == code)
+            return true;
     }
+    return false;
 }
+
+/** \brief report hides change
+ *
+ * Returns true when a modifier or key that `pending` adds to or removes from
+ * `sent` is back to its `sent` state in `next`, i.e. when replacing `pending`
+ * by `next` without sending it would hide a key press or release from the host.
+ */
+bool report_hides_change(report_keyboard_t* sent, report_keyboard_t* pending, report_keyboard_t* next)
+{
+    if ((pending->mods ^ sent->mods) & (pending->mods ^ next->mods))
+        return true;
+#ifdef NKRO_ENABLE
+    if (keyboard_protocol && keymap_config.nkro) {
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            if ((pending->nkro.bits[i] ^ sent->nkro.bits[i]) & (pending->nkro.bits[i] ^ next->nkro.bits[i]))
+                return true;
+        }
+        return false;
+    }
+#endif
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        uint8_t code = pending->keys[i];
+        if (code && !has_key_byte(sent, code) && !has_key_byte(next, code))
+            return true;
+        code = sent->keys[i];
+        if (code && !has_key_byte(pending, code) && has_key_byte(next, code))
+            return true;
+    }
+    return false;
+}
+#endif
@@ -19,6 +19,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #define REPORT_H
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "keycode.h"
 
 
@@ -84,6 +85,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
     #define KEYBOARD_REPORT_SIZE NKRO_EPSIZE
     #define KEYBOARD_REPORT_KEYS (NKRO_EPSIZE - 2)
     #define KEYBOARD_REPORT_BITS (NKRO_EPSIZE - 1)
+  #elif defined(NKRO_EPSIZE)
+    /* no USB protocol, such as in the unit tests */
+    #define KEYBOARD_REPORT_SIZE NKRO_EPSIZE
+    #define KEYBOARD_REPORT_KEYS (NKRO_EPSIZE - 2)
+    #define KEYBOARD_REPORT_BITS (NKRO_EPSIZE - 1)
   #else
     #error "NKRO not supported with this protocol"
 #endif
@@ -172,19 +178,36 @@ typedef struct {
     (key == KC_WWW_REFRESH      ?  AC_REFRESH : \
     (key == KC_WWW_FAVORITES    ?  AC_BOOKMARKS : 0)))))))))))))))))))))
 
-uint8_t has_anykey(report_keyboard_t* keyboard_report);
-uint8_t get_first_key(report_keyboard_t* keyboard_report);
-
-void add_key_byte(report_keyboard_t* keyboard_report, uint8_t code);
-void del_key_byte(report_keyboard_t* keyboard_report, uint8_t code);
+/*
+ * Keyboard report that keys are added to and removed from one at a time.
+ *
+ * It keeps track of the number of keys and of the first key as they change,
+ * so that asking for them doesn't need a scan of the report. In 6KRO the keys
+ * are kept in the order they were pressed, starting at keys[key_head]. With
+ * USB_6KRO_ENABLE they form a ring, and a new key replaces the oldest one when
+ * the report is full, otherwise key_head stays 0 and new keys are ignored when
+ * the report is full.
+ */
+typedef struct {
+    report_keyboard_t report;
+    uint8_t key_count;
+    uint8_t key_head;
 #ifdef NKRO_ENABLE
-void add_key_bit(report_keyboard_t* keyboard_report, uint8_t code);
-void del_key_bit(report_keyboard_t* keyboard_report, uint8_t code);
+    // The lowest key in the NKRO bits
+    uint8_t first_key;
 #endif
+} report_builder_t;
+
+uint8_t has_anykey(report_builder_t* builder);
+uint8_t get_first_key(report_builder_t* builder);
 
-void add_key_to_report(report_keyboard_t* keyboard_report, uint8_t key);
-void del_key_from_report(report_keyboard_t* keyboard_report, uint8_t key);
-void clear_keys_from_report(report_keyboard_t* keyboard_report);
+void add_key_to_report(report_builder_t* builder, uint8_t key);
+void del_key_from_report(report_builder_t* builder, uint8_t key);
+void clear_keys_from_report(report_builder_t* builder);
+
+#if defined(QMK_BATCH_SCAN) || defined(HOST_REPORT_QUEUE)
+bool report_hides_change(report_keyboard_t* sent, report_keyboard_t* pending, report_keyboard_t* next);
+#endif
 
 #ifdef __cplusplus
 }
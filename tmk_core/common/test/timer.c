@@ -15,6 +15,9 @@
  */
 
 #include "timer.h"
+#ifdef PROTOCOL_SIM
+#include <time.h>
+#endif
 
 static uint32_t current_time = 0;
 
@@ -26,6 +29,17 @@ uint16_t timer_read(void) { return current_time & 0xFFFF; }
 uint32_t timer_read32(void) { return current_time; }
 uint16_t timer_elapsed(uint16_t last) { return TIMER_DIFF_16(timer_read(), last); }
 uint32_t timer_elapsed32(uint32_t last) { return TIMER_DIFF_32(timer_read32(), last); }
+#ifdef PROTOCOL_SIM
+// The simulator measures how long the code takes on the host, while the
+// milliseconds only move with the scans
+uint32_t timer_read_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+#else
+uint32_t timer_read_us(void) { return current_time * 1000; }
+#endif
 
 void set_time(uint32_t t) { current_time = t; }
 void advance_time(uint32_t ms) { current_time += ms; }
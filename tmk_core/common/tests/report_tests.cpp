@@ -0,0 +1,269 @@
+/* Copyright 2018 QMK
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gtest/gtest.h"
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+extern "C" {
+#include "report.h"
+#include "keycode_config.h"
+
+uint8_t keyboard_protocol = 1;
+keymap_config_t keymap_config;
+}
+
+class Report : public testing::Test {
+public:
+    Report() {
+#ifdef NKRO_ENABLE
+        keymap_config.nkro = true;
+#endif
+    }
+
+    // The way the reports were queried before they kept track of their keys
+    static uint8_t scan_count(const report_keyboard_t& report) {
+        uint8_t count = 0;
+#ifdef NKRO_ENABLE
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_BITS; i++) {
+            count += __builtin_popcount(report.nkro.bits[i]);
+        }
+#else
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            count += report.keys[i] != 0;
+        }
+#endif
+        return count;
+    }
+
+    static std::vector<uint8_t> sorted_keys(const report_keyboard_t& report) {
+        std::vector<uint8_t> keys;
+#ifdef NKRO_ENABLE
+        for (uint8_t code = 0; code < KEYBOARD_REPORT_BITS * 8; code++) {
+            if (report.nkro.bits[code >> 3] & 1 << (code & 7)) {
+                keys.push_back(code);
+            }
+        }
+#else
+        for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+            if (report.keys[i]) {
+                keys.push_back(report.keys[i]);
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+#endif
+        return keys;
+    }
+
+    // The keys that should be in the report, oldest first
+    std::vector<uint8_t> model;
+
+    void model_add(uint8_t key) {
+        if (std::find(model.begin(), model.end(), key) != model.end()) {
+            return;
+        }
+#ifndef NKRO_ENABLE
+        if (model.size() == KEYBOARD_REPORT_KEYS) {
+#   ifdef USB_6KRO_ENABLE
+            model.erase(model.begin());
+#   else
+            return;
+#   endif
+        }
+#endif
+        model.push_back(key);
+    }
+
+    void model_del(uint8_t key) {
+        model.erase(std::remove(model.begin(), model.end(), key), model.end());
+    }
+
+    uint8_t model_first_key() {
+        if (model.empty()) {
+            return 0;
+        }
+#ifdef NKRO_ENABLE
+        return *std::min_element(model.begin(), model.end());
+#else
+        return model.front();
+#endif
+    }
+
+    void check(report_builder_t& builder) {
+        std::vector<uint8_t> expected = model;
+        std::sort(expected.begin(), expected.end());
+        ASSERT_EQ(sorted_keys(builder.report), expected);
+        ASSERT_EQ(has_anykey(&builder), scan_count(builder.report));
+        ASSERT_EQ(get_first_key(&builder), model_first_key());
+    }
+};
+
+TEST_F(Report, EmptyReportHasNoKeys) {
+    report_builder_t builder = {};
+    EXPECT_EQ(has_anykey(&builder), 0);
+    EXPECT_EQ(get_first_key(&builder), 0);
+}
+
+TEST_F(Report, KeysAreCountedOnce) {
+    report_builder_t builder = {};
+    add_key_to_report(&builder, KC_C);
+    add_key_to_report(&builder, KC_A);
+    add_key_to_report(&builder, KC_C);
+    EXPECT_EQ(has_anykey(&builder), 2);
+#ifdef NKRO_ENABLE
+    EXPECT_EQ(get_first_key(&builder), KC_A);
+#else
+    EXPECT_EQ(get_first_key(&builder), KC_C);
+#endif
+    del_key_from_report(&builder, KC_B);
+    EXPECT_EQ(has_anykey(&builder), 2);
+    del_key_from_report(&builder, KC_C);
+    EXPECT_EQ(has_anykey(&builder), 1);
+    EXPECT_EQ(get_first_key(&builder), KC_A);
+    del_key_from_report(&builder, KC_A);
+    EXPECT_EQ(has_anykey(&builder), 0);
+    EXPECT_EQ(get_first_key(&builder), 0);
+}
+
+TEST_F(Report, ClearKeepsTheMods) {
+    report_builder_t builder = {};
+    builder.report.mods = MOD_BIT(KC_LSFT);
+    add_key_to_report(&builder, KC_A);
+    add_key_to_report(&builder, KC_B);
+    clear_keys_from_report(&builder);
+    EXPECT_EQ(has_anykey(&builder), 0);
+    EXPECT_EQ(scan_count(builder.report), 0);
+    EXPECT_EQ(builder.report.mods, MOD_BIT(KC_LSFT));
+    add_key_to_report(&builder, KC_C);
+    EXPECT_EQ(get_first_key(&builder), KC_C);
+}
+
+TEST_F(Report, FullReport) {
+    report_builder_t builder = {};
+    for (uint8_t key = KC_A; key < KC_A + 8; key++) {
+        add_key_to_report(&builder, key);
+        model_add(key);
+        check(builder);
+    }
+#if defined(NKRO_ENABLE)
+    EXPECT_EQ(has_anykey(&builder), 8);
+#elif defined(USB_6KRO_ENABLE)
+    // The oldest keys made room for the newest
+    EXPECT_EQ(get_first_key(&builder), KC_C);
+#else
+    // The last keys didn't fit
+    EXPECT_EQ(sorted_keys(builder.report).back(), KC_F);
+#endif
+    del_key_from_report(&builder, KC_D);
+    model_del(KC_D);
+    check(builder);
+    add_key_to_report(&builder, KC_Z);
+    model_add(KC_Z);
+    check(builder);
+}
+
+TEST_F(Report, RandomPressesAndReleases) {
+    report_builder_t builder = {};
+    std::mt19937 rng(1);
+    for (int i = 0; i < 20000; i++) {
+        uint8_t key = KC_A + rng() % 12;
+        if (rng() % 2) {
+            add_key_to_report(&builder, key);
+            model_add(key);
+        } else {
+            del_key_from_report(&builder, key);
+            model_del(key);
+        }
+        check(builder);
+        if (rng() % 500 == 0) {
+            clear_keys_from_report(&builder);
+            model.clear();
+        }
+    }
+}
+
+// The queries as they were before the reports kept track of their keys
+static uint8_t rescan_has_anykey(const report_keyboard_t& report) {
+    uint8_t cnt = 0;
+    for (uint8_t i = 1; i < KEYBOARD_REPORT_SIZE; i++) {
+        if (report.raw[i])
+            cnt++;
+    }
+    return cnt;
+}
+
+static uint8_t rescan_first_key(const report_keyboard_t& report) {
+#ifdef NKRO_ENABLE
+    uint8_t i = 0;
+    for (; i < KEYBOARD_REPORT_BITS && !report.nkro.bits[i]; i++)
+        ;
+    return i < KEYBOARD_REPORT_BITS ? i << 3 | __builtin_ctz(report.nkro.bits[i]) : 0;
+#else
+    for (uint8_t i = 0; i < KEYBOARD_REPORT_KEYS; i++) {
+        if (report.keys[i])
+            return report.keys[i];
+    }
+    return 0;
+#endif
+}
+
+TEST_F(Report, benchmark_queries) {
+    // Presses and releases of a few keys at a time, each followed by the
+    // queries, as send_keyboard_report makes them while one shot mods are pending
+    const int iterations = 1 << 21;
+    std::mt19937 rng(2);
+    uint8_t keys[4096];
+    for (auto& key: keys) {
+        key = KC_A + rng() % 8;
+    }
+    report_builder_t builder = {};
+    volatile uint32_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        uint8_t key = keys[i & 4095];
+        if (i & 1) {
+            add_key_to_report(&builder, key);
+        } else {
+            del_key_from_report(&builder, key);
+        }
+        sink = sink + rescan_has_anykey(builder.report) + rescan_first_key(builder.report);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        uint8_t key = keys[i & 4095];
+        if (i & 1) {
+            add_key_to_report(&builder, key);
+        } else {
+            del_key_from_report(&builder, key);
+        }
+        sink = sink + has_anykey(&builder) + get_first_key(&builder);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double before = std::chrono::duration<double, std::nano>(middle - start).count() / iterations;
+    double after = std::chrono::duration<double, std::nano>(end - middle).count() / iterations;
+#if defined(NKRO_ENABLE)
+    const char* mode = "nkro";
+#elif defined(USB_6KRO_ENABLE)
+    const char* mode = "ring 6kro";
+#else
+    const char* mode = "6kro";
+#endif
+    printf("[ BENCHMARK] %s: %.1f ns per change and queries with a rescan, %.1f ns with the kept state\n",
+        mode, before, after);
+}
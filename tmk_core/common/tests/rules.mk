@@ -0,0 +1,15 @@
+REPORT_COMMON_DEFS := -DNO_PRINT -DNO_DEBUG
+
+REPORT_COMMON_SRC := \
+	$(TMK_PATH)/common/tests/report_tests.cpp \
+	$(TMK_PATH)/common/report.c \
+	$(TMK_PATH)/common/util.c
+
+report_6kro_DEFS := $(REPORT_COMMON_DEFS)
+report_6kro_SRC := $(REPORT_COMMON_SRC)
+
+report_ring_6kro_DEFS := $(REPORT_COMMON_DEFS) -DUSB_6KRO_ENABLE
+report_ring_6kro_SRC := $(REPORT_COMMON_SRC)
+
+report_nkro_DEFS := $(REPORT_COMMON_DEFS) -DNKRO_ENABLE -DNKRO_EPSIZE=32
+report_nkro_SRC := $(REPORT_COMMON_SRC)
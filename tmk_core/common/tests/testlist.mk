@@ -0,0 +1,4 @@
+TEST_LIST +=\
+	report_6kro\
+	report_ring_6kro\
+	report_nkro
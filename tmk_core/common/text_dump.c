@@ -0,0 +1,62 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "text_dump.h"
+#ifdef RAW_ENABLE
+#   include <string.h>
+#   include "raw_hid.h"
+#endif
+
+void text_send_str(text_send_t send, const char *str)
+{
+    while (*str)
+        send(*str++);
+}
+
+#ifdef RAW_ENABLE
+/* the size of a raw HID report */
+#define RAW_HID_REPORT_SIZE 32
+
+static uint8_t raw_hid_report[RAW_HID_REPORT_SIZE];
+static uint8_t raw_hid_report_length;
+
+static int8_t send_raw_hid(uint8_t c)
+{
+    raw_hid_report[raw_hid_report_length++] = c;
+    if (raw_hid_report_length == RAW_HID_REPORT_SIZE) {
+        raw_hid_send(raw_hid_report, RAW_HID_REPORT_SIZE);
+        raw_hid_report_length = 0;
+    }
+    return 0;
+}
+
+/** \brief Text dump raw HID
+ *
+ * Sends the text written by dump over raw HID, the last report is padded
+ * with zeros.
+ */
+void text_dump_raw_hid(void (*dump)(text_send_t send))
+{
+    raw_hid_report_length = 0;
+    dump(send_raw_hid);
+    if (raw_hid_report_length) {
+        memset(raw_hid_report + raw_hid_report_length, 0, RAW_HID_REPORT_SIZE - raw_hid_report_length);
+        raw_hid_send(raw_hid_report, RAW_HID_REPORT_SIZE);
+        raw_hid_report_length = 0;
+    }
+}
+#endif
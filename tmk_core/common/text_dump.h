@@ -0,0 +1,36 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TEXT_DUMP_H
+#define TEXT_DUMP_H
+
+#include <stdint.h>
+
+/* Helpers for the text dumps of the flight recorder and the perf stats,
+ * which write one character at a time through a send function, like
+ * sendchar().
+ */
+
+typedef int8_t (*text_send_t)(uint8_t c);
+
+void text_send_str(text_send_t send, const char *str);
+
+#ifdef RAW_ENABLE
+void text_dump_raw_hid(void (*dump)(text_send_t send));
+#endif
+
+#endif
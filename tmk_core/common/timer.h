@@ -45,6 +45,8 @@ uint16_t timer_read(void);
 uint32_t timer_read32(void);
 uint16_t timer_elapsed(uint16_t last);
 uint32_t timer_elapsed32(uint32_t last);
+/* microseconds, with the resolution of the platform, for measuring short times */
+uint32_t timer_read_us(void);
 
 #ifdef __cplusplus
 }
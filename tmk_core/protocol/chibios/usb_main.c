@@ -611,6 +611,9 @@ void nkro_in_cb(USBDriver *usbp, usbep_t ep) {
  *  so that this is not going to have to be checked every 1ms */
 void kbd_sof_cb(USBDriver *usbp) {
   (void)usbp;
+#ifdef HOST_REPORT_QUEUE
+  host_start_of_frame();
+#endif
 }
 
 /* Idle requests timer code
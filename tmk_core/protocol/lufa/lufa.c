@@ -54,6 +54,7 @@
 #include "quantum.h"
 #include <util/atomic.h>
 #include "outputselect.h"
+#include "perf_stats.h"
 
 #ifdef NKRO_ENABLE
   #include "keycode_config.h"
@@ -377,7 +378,9 @@ static bool console_flush = false;
     console_flush = b; \
   } \
 } while (0)
+#endif
 
+#if defined(CONSOLE_ENABLE) || defined(HOST_REPORT_QUEUE)
 /** \brief Event USB Device Start Of Frame
  *
  * FIXME: Needs doc
@@ -385,6 +388,11 @@ static bool console_flush = false;
  */
 void EVENT_USB_Device_StartOfFrame(void)
 {
+#ifdef HOST_REPORT_QUEUE
+    host_start_of_frame();
+#endif
+
+#ifdef CONSOLE_ENABLE
     static uint8_t count;
     if (++count % 50) return;
     count = 0;
@@ -392,6 +400,7 @@ void EVENT_USB_Device_StartOfFrame(void)
     if (!console_flush) return;
     Console_Task();
     console_flush = false;
+#endif
 }
 
 #endif
@@ -1075,7 +1084,7 @@ int main(void)
 #endif
 
 #if defined(RGBLIGHT_ANIMATIONS) & defined(RGBLIGHT_ENABLE)
-        rgblight_task();
+        PERF_MEASURE(PERF_LIGHTING, rgblight_task());
 #endif
 
 #ifdef MODULE_ADAFRUIT_BLE
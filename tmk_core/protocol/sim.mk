@@ -0,0 +1,44 @@
+SIM_DIR = protocol/sim
+
+# The matrix and the host are simulated, and so are the LED strips of
+# rgblight, the registers that keyboard files use for their LEDs, and the
+# I2C bus. These features need hardware that the simulator doesn't have.
+CUSTOM_MATRIX = yes
+AUDIO_ENABLE = no
+FAUXCLICKY_ENABLE = no
+BACKLIGHT_ENABLE = no
+RGB_MATRIX_ENABLE = no
+RGBLIGHT_CUSTOM_DRIVER = no
+MIDI_ENABLE = no
+API_SYSEX_ENABLE = no
+BLUETOOTH_ENABLE = no
+BLUETOOTH =
+VIRTSER_ENABLE = no
+STENO_ENABLE = no
+RAW_ENABLE = no
+CONSOLE_ENABLE = no
+SLEEP_LED_ENABLE = no
+VISUALIZER_ENABLE = no
+SERIAL_LINK_ENABLE = no
+SPLIT_KEYBOARD = no
+LCD_ENABLE = no
+PRINTING_ENABLE = no
+POINTING_DEVICE_ENABLE = no
+PS2_MOUSE_ENABLE =
+KEYMAP_SECTION_ENABLE = no
+# no bootloader to jump to
+BOOTLOADER =
+# the stage times of the report
+PERF_STATS_ENABLE ?= yes
+
+SRC += $(SIM_DIR)/sim.c \
+	$(SIM_DIR)/sim_main.c \
+	$(SIM_DIR)/avr/io.c \
+	$(SIM_DIR)/i2c_master.c \
+	$(COMMON_DIR)/sendchar_null.c
+
+OPT_DEFS += -DPROTOCOL_SIM
+# the NKRO report size of the USB protocols
+OPT_DEFS += -DNKRO_EPSIZE=32
+
+VPATH += $(TMK_PATH)/$(SIM_DIR)
@@ -0,0 +1,31 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "avr/io.h"
+
+volatile uint8_t PINA, DDRA, PORTA;
+volatile uint8_t PINB, DDRB, PORTB;
+volatile uint8_t PINC, DDRC, PORTC;
+volatile uint8_t PIND, DDRD, PORTD;
+volatile uint8_t PINE, DDRE, PORTE;
+volatile uint8_t PINF, DDRF, PORTF;
+
+volatile uint8_t TCCR1A, TCCR1B, TCCR3A, TCCR3B, TCCR4A, TCCR4B;
+volatile uint16_t OCR1A, OCR1B, OCR1C, OCR3A, OCR3B, OCR3C;
+volatile uint8_t OCR4A, OCR4B, OCR4C, OCR4D;
+volatile uint8_t CLKPR;
+volatile uint8_t MCUCR;
@@ -0,0 +1,48 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIM_AVR_IO_H
+#define SIM_AVR_IO_H
+
+#include <stdint.h>
+
+/*
+ * The AVR registers that keyboard headers use for their LEDs, as plain
+ * variables, so that keymaps of AVR keyboards compile for the simulator.
+ * Writing them has no effect.
+ */
+
+#define _BV(bit) (1 << (bit))
+
+extern volatile uint8_t PINA, DDRA, PORTA;
+extern volatile uint8_t PINB, DDRB, PORTB;
+extern volatile uint8_t PINC, DDRC, PORTC;
+extern volatile uint8_t PIND, DDRD, PORTD;
+extern volatile uint8_t PINE, DDRE, PORTE;
+extern volatile uint8_t PINF, DDRF, PORTF;
+
+/* the PWM timers that drive LED brightness */
+extern volatile uint8_t TCCR1A, TCCR1B, TCCR3A, TCCR3B, TCCR4A, TCCR4B;
+extern volatile uint16_t OCR1A, OCR1B, OCR1C, OCR3A, OCR3B, OCR3C;
+extern volatile uint8_t OCR4A, OCR4B, OCR4C, OCR4D;
+extern volatile uint8_t CLKPR;
+
+/* writing JTD twice turns off JTAG, so the port F pins can be used */
+#define JTD 7
+extern volatile uint8_t MCUCR;
+
+#endif
@@ -0,0 +1,180 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string.h>
+#include "sim.h"
+#include "host.h"
+#include "host_driver.h"
+#include "keyboard.h"
+#include "matrix.h"
+#include "quantum.h"
+
+/* from the test timer, see tmk_core/common/test/timer.c */
+void advance_time(uint32_t ms);
+
+static matrix_row_t matrix[MATRIX_ROWS];
+static sim_reports_t reports;
+static report_keyboard_t last_keyboard_report;
+static uint8_t host_leds = 0;
+
+/* the report protocol, as the host sets it over USB */
+uint8_t keyboard_idle = 0;
+uint8_t keyboard_protocol = 1;
+
+static uint8_t keyboard_leds(void)
+{
+    return host_leds;
+}
+
+static void send_keyboard(report_keyboard_t *report)
+{
+    last_keyboard_report = *report;
+    reports.keyboard++;
+}
+
+static void send_mouse(report_mouse_t *report)
+{
+    reports.mouse++;
+}
+
+static void send_system(uint16_t data)
+{
+    reports.system++;
+}
+
+static void send_consumer(uint16_t data)
+{
+    reports.consumer++;
+}
+
+static host_driver_t sim_driver = {
+    keyboard_leds,
+    send_keyboard,
+    send_mouse,
+    send_system,
+    send_consumer
+};
+
+uint8_t matrix_rows(void)
+{
+    return MATRIX_ROWS;
+}
+
+uint8_t matrix_cols(void)
+{
+    return MATRIX_COLS;
+}
+
+void matrix_init(void)
+{
+    memset(matrix, 0, sizeof(matrix));
+    matrix_init_quantum();
+}
+
+uint8_t matrix_scan(void)
+{
+    matrix_scan_quantum();
+    return 1;
+}
+
+bool matrix_is_on(uint8_t row, uint8_t col)
+{
+    return matrix[row] & ((matrix_row_t)1 << col);
+}
+
+matrix_row_t matrix_get_row(uint8_t row)
+{
+    return matrix[row];
+}
+
+void matrix_print(void)
+{
+}
+
+/* the keyboard's sources are left out, so these are in place of them */
+__attribute__ ((weak))
+void matrix_init_kb(void)
+{
+    matrix_init_user();
+}
+
+__attribute__ ((weak))
+void matrix_scan_kb(void)
+{
+    matrix_scan_user();
+}
+
+__attribute__ ((weak))
+void matrix_init_user(void)
+{
+}
+
+__attribute__ ((weak))
+void matrix_scan_user(void)
+{
+}
+
+/** \brief Sim init
+ *
+ * The driver is set first, so that the reports sent while starting up are
+ * counted too.
+ */
+void sim_init(void)
+{
+    host_set_driver(&sim_driver);
+    keyboard_setup();
+    keyboard_init();
+}
+
+void sim_set_key(uint8_t row, uint8_t col, bool pressed)
+{
+    if (pressed)
+        matrix[row] |= (matrix_row_t)1 << col;
+    else
+        matrix[row] &= ~((matrix_row_t)1 << col);
+}
+
+bool sim_get_key(uint8_t row, uint8_t col)
+{
+    return matrix_is_on(row, col);
+}
+
+void sim_scan(void)
+{
+    keyboard_task();
+    advance_time(1);
+}
+
+const sim_reports_t *sim_reports(void)
+{
+    return &reports;
+}
+
+const report_keyboard_t *sim_last_keyboard_report(void)
+{
+    return &last_keyboard_report;
+}
+
+void sim_set_leds(uint8_t leds)
+{
+    host_leds = leds;
+}
+
+void sim_leds_sent(void)
+{
+    reports.leds++;
+}
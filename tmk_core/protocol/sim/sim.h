@@ -0,0 +1,62 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "report.h"
+
+/*
+ * Simulator: runs the firmware of a keymap on the host, with a matrix that
+ * the caller sets and a host driver that counts the reports. The time only
+ * moves when sim_scan() is called, a millisecond per scan, so the keymap
+ * behaves the same however fast the host runs it.
+ */
+
+typedef struct {
+    uint32_t keyboard;
+    uint32_t mouse;
+    uint32_t system;
+    uint32_t consumer;
+    /* LED strip updates, from rgblight */
+    uint32_t leds;
+} sim_reports_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* starts the firmware the way the keyboard's main() does */
+void sim_init(void);
+void sim_set_key(uint8_t row, uint8_t col, bool pressed);
+bool sim_get_key(uint8_t row, uint8_t col);
+/* runs keyboard_task() once, then moves the time on by a millisecond */
+void sim_scan(void);
+const sim_reports_t *sim_reports(void);
+const report_keyboard_t *sim_last_keyboard_report(void);
+/* the LED state the host reports back, caps lock and so on */
+void sim_set_leds(uint8_t leds);
+/* called by the simulated LED drivers */
+void sim_leds_sent(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
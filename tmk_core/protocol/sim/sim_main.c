@@ -0,0 +1,308 @@
+/*
+Copyright 2018 QMK
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+ * The simulator driver: streams a key event workload through the firmware
+ * as fast as the host can run it, and reports the throughput, the time
+ * spent in each stage and the peak stack use.
+ *
+ * The workload is either synthetic typing on the keys of the base layer,
+ * or the events of a flight recorder dump, see flight_recorder.h.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include "sim.h"
+#include "keymap.h"
+#include "keycode.h"
+#include "perf_stats.h"
+
+/* the stack the workload runs on, painted to find the peak use */
+#define SIM_STACK_SIZE (1024 * 1024)
+#define SIM_STACK_PAINT 0xA5
+
+typedef struct {
+    /* milliseconds from the start of the workload */
+    uint32_t time;
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+} sim_event_t;
+
+static sim_event_t *events;
+static uint32_t event_count;
+static uint32_t event_capacity;
+static uint32_t scans;
+
+static ucontext_t main_context;
+static ucontext_t workload_context;
+
+static void add_event(uint32_t time, uint8_t row, uint8_t col, bool pressed)
+{
+    if (event_count == event_capacity) {
+        event_capacity = event_capacity ? event_capacity * 2 : 1024;
+        events = realloc(events, event_capacity * sizeof(sim_event_t));
+        if (!events) {
+            fprintf(stderr, "Out of memory\n");
+            exit(1);
+        }
+    }
+    events[event_count++] = (sim_event_t){ time, row, col, pressed };
+}
+
+static int compare_events(const void *a, const void *b)
+{
+    const sim_event_t *first = a;
+    const sim_event_t *second = b;
+    if (first->time != second->time)
+        return first->time < second->time ? -1 : 1;
+    // a key released at the same time as it's pressed again goes first
+    return (int)first->pressed - (int)second->pressed;
+}
+
+/* xorshift, so that a seed gives the same workload everywhere */
+static uint32_t random_state;
+
+static uint32_t random_below(uint32_t limit)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state % limit;
+}
+
+/** \brief Synthetic workload
+ *
+ * Taps random keys of the base layer, held for 30 to 150 ms and 15 to 120 ms
+ * apart, so that fast typing rolls over several keys.
+ */
+static bool load_synthetic(uint32_t count, uint32_t seed)
+{
+    keypos_t keys[MATRIX_ROWS * MATRIX_COLS];
+    uint32_t released[MATRIX_ROWS * MATRIX_COLS];
+    uint16_t key_count = 0;
+
+    for (uint8_t row = 0; row < MATRIX_ROWS; row++) {
+        for (uint8_t col = 0; col < MATRIX_COLS; col++) {
+            keypos_t key = { .row = row, .col = col };
+            uint16_t keycode = keymap_key_to_keycode(0, key);
+            if (keycode != KC_NO && keycode != KC_TRNS) {
+                released[key_count] = 0;
+                keys[key_count++] = key;
+            }
+        }
+    }
+    if (!key_count) {
+        fprintf(stderr, "The base layer has no keys\n");
+        return false;
+    }
+
+    random_state = seed ? seed : 1;
+    uint32_t time = 0;
+    for (uint32_t i = 0; i < count / 2; i++) {
+        time += 15 + random_below(106);
+        uint16_t index = random_below(key_count);
+        // take the next key that isn't held down at this point
+        for (uint16_t tries = 0; released[index] >= time && tries < key_count; tries++)
+            index = (index + 1) % key_count;
+        if (released[index] >= time)
+            time = released[index] + 1;
+        released[index] = time + 30 + random_below(121);
+        add_event(time, keys[index].row, keys[index].col, true);
+        add_event(released[index], keys[index].row, keys[index].col, false);
+    }
+    qsort(events, event_count, sizeof(sim_event_t), compare_events);
+    return true;
+}
+
+/** \brief Flight recorder workload
+ *
+ * Reads the events of a dump, skipping any other console output around it,
+ * and repeats them with a second in between.
+ */
+static bool load_flight(const char *path, uint32_t repeat)
+{
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Can't open %s\n", path);
+        return false;
+    }
+
+    char line[128];
+    bool in_dump = false;
+    bool complete = false;
+    uint32_t first = event_count;
+    uint32_t time = 0;
+    uint16_t last_time = 0;
+    while (fgets(line, sizeof(line), file)) {
+        unsigned event_time, row, col, pressed;
+        unsigned long layer_state;
+        if (!strncmp(line, "FLIGHT ", 7)) {
+            in_dump = true;
+            event_count = first;
+            time = 0;
+        } else if (in_dump && !strncmp(line, "END", 3)) {
+            complete = true;
+            break;
+        } else if (in_dump && sscanf(line, "E %x %x %x %x %lx", &event_time, &row, &col, &pressed, &layer_state) == 5) {
+            if (event_count > first)
+                time += (uint16_t)(event_time - last_time);
+            last_time = event_time;
+            if (row >= MATRIX_ROWS || col >= MATRIX_COLS) {
+                fprintf(stderr, "The key %u,%u in %s isn't in the matrix\n", row, col, path);
+                fclose(file);
+                return false;
+            }
+            add_event(time, row, col, pressed);
+        }
+    }
+    fclose(file);
+    if (!complete) {
+        fprintf(stderr, "There is no complete dump in %s\n", path);
+        return false;
+    }
+
+    uint32_t length = event_count - first;
+    uint32_t period = length ? events[event_count - 1].time + 1000 : 0;
+    for (uint32_t copy = 1; copy < repeat; copy++) {
+        for (uint32_t i = 0; i < length; i++) {
+            sim_event_t event = events[first + i];
+            add_event(event.time + copy * period, event.row, event.col, event.pressed);
+        }
+    }
+    return true;
+}
+
+/** \brief Run workload
+ *
+ * Scans until the time of each event, then gives the event a scan of its
+ * own, like FlightReplay in the tests. Ends with a second of idle scans so
+ * that everything held is released.
+ */
+static void run_workload(void)
+{
+    uint32_t time = 0;
+    for (uint32_t i = 0; i < event_count; i++) {
+        while (time < events[i].time) {
+            sim_scan();
+            time++;
+        }
+        sim_set_key(events[i].row, events[i].col, events[i].pressed);
+        sim_scan();
+        time++;
+    }
+    for (uint32_t i = 0; i < 1000; i++) {
+        sim_scan();
+        time++;
+    }
+    scans = time;
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+static void usage(const char *name)
+{
+    printf("Usage: %s [--events N] [--seed N] [--flight FILE] [--repeat N]\n"
+        "  --events N     synthetic typing with N key events, 100000 by default\n"
+        "  --seed N       the seed of the synthetic typing\n"
+        "  --flight FILE  replays the events of a flight recorder dump instead\n"
+        "  --repeat N     replays the dump N times\n", name);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t count = 100000;
+    uint32_t seed = 1;
+    uint32_t repeat = 1;
+    const char *flight = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--events") && i + 1 < argc) {
+            count = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--seed") && i + 1 < argc) {
+            seed = strtoul(argv[++i], NULL, 0);
+        } else if (!strcmp(argv[i], "--flight") && i + 1 < argc) {
+            flight = argv[++i];
+        } else if (!strcmp(argv[i], "--repeat") && i + 1 < argc) {
+            repeat = strtoul(argv[++i], NULL, 0);
+        } else {
+            usage(argv[0]);
+            return strcmp(argv[i], "--help") ? 1 : 0;
+        }
+    }
+
+    sim_init();
+    if (flight ? !load_flight(flight, repeat ? repeat : 1) : !load_synthetic(count, seed))
+        return 1;
+#ifdef PERF_STATS_ENABLE
+    perf_stats_clear();
+#endif
+
+    uint8_t *stack = malloc(SIM_STACK_SIZE);
+    if (!stack) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+    memset(stack, SIM_STACK_PAINT, SIM_STACK_SIZE);
+    getcontext(&workload_context);
+    workload_context.uc_stack.ss_sp = stack;
+    workload_context.uc_stack.ss_size = SIM_STACK_SIZE;
+    workload_context.uc_link = &main_context;
+    makecontext(&workload_context, run_workload, 0);
+
+    uint64_t start = now_ns();
+    swapcontext(&main_context, &workload_context);
+    uint64_t elapsed = now_ns() - start;
+    if (!elapsed)
+        elapsed = 1;
+
+    // the stack grows down, from the end of the buffer
+    uint32_t unused = 0;
+    while (unused < SIM_STACK_SIZE && stack[unused] == SIM_STACK_PAINT)
+        unused++;
+
+    const sim_reports_t *reports = sim_reports();
+    printf("keymap      %s:%s\n", QMK_KEYBOARD, QMK_KEYMAP);
+    if (flight)
+        printf("workload    %s, %u times\n", flight, repeat ? repeat : 1);
+    else
+        printf("workload    synthetic, seed %u\n", seed);
+    printf("events      %u in %u scans, %.3f s simulated\n", event_count, scans, scans / 1000.0);
+    printf("reports     keyboard %u, mouse %u, system %u, consumer %u, leds %u\n",
+        reports->keyboard, reports->mouse, reports->system, reports->consumer, reports->leds);
+    printf("host time   %.3f ms\n", elapsed / 1e6);
+    printf("events/sec  %.0f\n", event_count * 1e9 / elapsed);
+    printf("scans/sec   %.0f\n", scans * 1e9 / elapsed);
+#ifdef PERF_STATS_ENABLE
+    printf("stage            count    total us    avg ns    max us\n");
+    for (uint8_t i = 0; i < PERF_COUNTERS; i++) {
+        const perf_stat_t *stat = perf_stats_get(i);
+        printf("%-14s %7u %11u %9.0f %9u\n", perf_stats_name(i), stat->count, stat->total,
+            stat->count ? stat->total * 1000.0 / stat->count : 0.0, stat->max);
+    }
+#endif
+    printf("peak stack  %u bytes\n", SIM_STACK_SIZE - unused);
+    return 0;
+}
@@ -284,6 +284,15 @@ BEGIN = gccversion sizebefore
 	@$(SILENT) || printf "$(MSG_LINKING) $@" | $(AWK_CMD)
 	$(eval CMD=$(CC) $(ALL_CFLAGS) $(filter-out %.txt,$^) --output $@ $(LDFLAGS))
 	@$(BUILD_CMD)
+
+# Sparse keymap: the tables are made from the keymaps array in the compiled
+# keymap, see quantum/keymap_sparse.h
+ifdef SPARSE_KEYMAP_TABLE
+$(SPARSE_KEYMAP_TABLE): $(SPARSE_KEYMAP_OBJ) $(QUANTUM_PATH)/keymap_sparse.awk
+	@$(SILENT) || printf "$(MSG_GENERATING) $@" | $(AWK_CMD)
+	$(eval CMD=$(or $(OBJCOPY),objcopy) -O binary --wildcard -j '*.keymaps' $< $@.bin && od -An -v -tx1 $@.bin | $(AWK) -f $(QUANTUM_PATH)/keymap_sparse.awk > $@.tmp && mv -f $@.tmp $@ && rm -f $@.bin)
+	@$(BUILD_CMD)
+endif
 	
 
 define GEN_OBJRULE
@@ -0,0 +1,77 @@
+#!/bin/sh
+# Compares the flash used by the firmware with the dense and the sparse
+# (SPARSE_KEYMAP_ENABLE) keymap. Each keymap is built twice for its keyboard,
+# and the flash is the text and data of the linked .elf, as shown by avr-size
+# or arm-none-eabi-size. The number of keys, and how many of them are stored,
+# come from the generated sparse tables.
+#
+# Usage:   util/sparse_keymap_report.sh <keyboard>[:<keymap>]... [-- <make options>]
+# Example: util/sparse_keymap_report.sh planck/rev6 ergodox_ez:default
+
+KEYMAPS=
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+    case "$1" in
+        *:*) KEYMAPS="$KEYMAPS $1" ;;
+        *)
+            # the keymaps can be in the folder of the keyboard or of its parents
+            FOLDER=$1
+            while true; do
+                for dir in keyboards/$FOLDER/keymaps/*/; do
+                    [ -f "$dir/keymap.c" ] && KEYMAPS="$KEYMAPS $1:$(basename "$dir")"
+                done
+                [ "$FOLDER" = "${FOLDER%/*}" ] && break
+                FOLDER=${FOLDER%/*}
+            done
+            ;;
+    esac
+    shift
+done
+[ "$1" = "--" ] && shift
+
+if [ -z "$KEYMAPS" ]; then
+    echo "Usage:   $0 <keyboard>[:<keymap>]... [-- <make options>]"
+    echo "Example: $0 planck/rev6 ergodox_ez:default"
+    exit 1
+fi
+
+# prints the text + data of an .elf, with the size tool of its architecture
+flash_size() {
+    for SIZE in avr-size arm-none-eabi-size; do
+        # "   text    data     bss     dec     hex filename"
+        $SIZE "$1" 2> /dev/null | awk 'NR == 2 { print $1 + $2; found = 1 } END { exit !found }' && return 0
+    done
+    return 1
+}
+
+# builds the keymap and prints its flash size, pass SPARSE_KEYMAP_ENABLE and
+# the make options
+build_flash_size() {
+    rm -rf "$OBJ" "$ELF"
+    make "$KEYMAP" "$@" > /dev/null 2>&1 && flash_size "$ELF"
+}
+
+printf "%-40s %6s %6s %7s %7s %6s\n" keymap keys stored dense sparse saved
+DENSE_TOTAL=0
+SPARSE_TOTAL=0
+SKIPPED=0
+for KEYMAP in $KEYMAPS; do
+    TARGET=$(echo "${KEYMAP%%:*}" | tr / _)_${KEYMAP#*:}
+    ELF=.build/$TARGET.elf
+    OBJ=.build/obj_$TARGET
+    if ! DENSE=$(build_flash_size SPARSE_KEYMAP_ENABLE=no "$@") ||
+       ! SPARSE=$(build_flash_size SPARSE_KEYMAP_ENABLE=yes "$@"); then
+        SKIPPED=$((SKIPPED + 1))
+        continue
+    fi
+    # " * 120 keys, 42 of them stored"
+    KEYS=$(sed -n 's/^ \* \([0-9]*\) keys, \([0-9]*\) of them stored$/\1 \2/p' "$OBJ/keymap_sparse_table.c")
+    printf "%-40s %6d %6d %7d %7d %5d%%\n" "$KEYMAP" ${KEYS% *} ${KEYS#* } $DENSE $SPARSE $(( (100 * (DENSE - SPARSE)) / DENSE ))
+    DENSE_TOTAL=$((DENSE_TOTAL + DENSE))
+    SPARSE_TOTAL=$((SPARSE_TOTAL + SPARSE))
+done
+
+if [ $DENSE_TOTAL -gt 0 ]; then
+    printf "%-40s %6s %6s %7d %7d %5d%%\n" total "" "" $DENSE_TOTAL $SPARSE_TOTAL $(( (100 * (DENSE_TOTAL - SPARSE_TOTAL)) / DENSE_TOTAL ))
+fi
+[ $SKIPPED -gt 0 ] && echo "$SKIPPED keymaps didn't build, or no size tool was found for them, and were skipped"
+exit 0